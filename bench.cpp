@@ -0,0 +1,417 @@
+// Engine benchmarks (no Qt).
+//
+//   bench smp [--depth N] [--hash MB] [--large-pages] [--threads 1,2,4,8,16] [--no-null] [--no-lmr]
+//             [--stats]
+//   bench eval [--fen "<FEN>"]
+//   bench alloc [--depth N]
+//   bench see
+//   bench draw
+//
+// smp: searches a fixed set of positions to a fixed depth with each thread
+// count and reports time-to-depth, nodes and nodes/s, the speedup over the
+// single-threaded run and the first-move cutoff rate (move-ordering quality).
+// The hash is cleared before every position so each run starts cold.
+// --no-null / --no-lmr switch off null-move pruning / late-move reductions;
+// --stats adds the hit counters of every pruning rule under each row;
+// --large-pages backs the hash with huge pages where the OS allows.
+//
+// eval: prints the evaluation terms of one position (or of every bench
+// position) and times the static evaluation.
+//
+// alloc: counts heap allocations made by single-threaded searches after a
+// warm-up search; the search hot path must not allocate at all.
+//
+// see: checks the static exchange evaluator against a set of known exchanges
+// (x-rays, en passant, promotions, king recaptures) and times it over every
+// capture of the bench positions.
+//
+// draw: checks that the search scores repetitions and fifty-move draws as 0,
+// so the side behind steers into them and the side ahead steers clear.
+
+#include "board.h"
+#include "engine.h"
+#include "eval.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Middlegame and endgame positions with enough choice to keep all threads busy
+static const char *BenchFENs[] = {
+    StartFEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2NBPN2/PP3PPP/R1BQK2R w KQ - 0 8",
+    "r2q1rk1/1b2bppp/p2ppn2/1p6/3NP3/1BN1Q3/PPP2PPP/R4RK1 w - - 0 13",
+    "2r2rk1/pp1bqppp/2n1pn2/3p4/3P4/2PBPN2/P1QN1PPP/R4RK1 b - - 0 14",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+// Every allocation in this program goes through here so `bench alloc` can count them
+static std::atomic<unsigned long long> allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<int> parseList(const std::string &text)
+{
+    std::vector<int> values;
+    std::stringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ','))
+        if (std::atoi(item.c_str()) > 0) values.push_back(std::atoi(item.c_str()));
+    return values;
+}
+
+// ----------------------------------------------
+// SMP SCALING
+// ----------------------------------------------
+static int benchSmp(int argc, char *argv[])
+{
+    int depth = 5;
+    size_t hashMb = 64;
+    std::vector<int> threadCounts = { 1, 2, 4, 8, 16 };
+    SearchOptions options;
+    bool showStats = false;
+    bool largePages = false;
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) depth = std::atoi(argv[++i]);
+        else if (arg == "--hash" && hasValue) hashMb = size_t(std::atoi(argv[++i]));
+        else if (arg == "--large-pages") largePages = true;
+        else if (arg == "--threads" && hasValue) threadCounts = parseList(argv[++i]);
+        else if (arg == "--no-null") options.nullMove = false;
+        else if (arg == "--no-lmr") options.lateMoveReductions = false;
+        else if (arg == "--stats") showStats = true;
+        else { std::printf("unknown option: %s\n", arg.c_str()); return 2; }
+    }
+
+    Engine engine;
+    engine.setHashSize(hashMb, largePages);
+    engine.setOptions(options);
+
+    std::printf("depth %d, hash %zu MB%s, %zu positions\n\n", depth, hashMb, largePages ? " (large pages)" : "",
+                sizeof(BenchFENs) / sizeof(BenchFENs[0]));
+    std::printf("%8s %10s %14s %12s %9s %9s %9s\n", "threads", "time (s)", "nodes", "nodes/s", "speedup", "nodes x",
+                "cut-1st");
+
+    double baseTime = 0;
+    unsigned long long baseNodes = 0;
+
+    for (int threads : threadCounts) {
+        engine.setThreads(threads);
+
+        double seconds = 0;
+        unsigned long long nodes = 0;
+        SearchStats stats;
+        for (const char *fen : BenchFENs) {
+            board b;
+            bool white = true;
+            b.loadFEN(fen, white);
+            engine.clearHash();
+
+            SearchLimits limits;
+            limits.depth = depth;
+            auto start = std::chrono::steady_clock::now();
+            engine.search(b, white, limits);
+            seconds += secondsSince(start);
+            nodes += engine.lastNodes();
+            SearchStats s = engine.lastStats();
+            stats.cutoffs += s.cutoffs;
+            stats.firstMoveCutoffs += s.firstMoveCutoffs;
+            stats.nullMoveCutoffs += s.nullMoveCutoffs;
+            stats.lmrResearches += s.lmrResearches;
+            stats.reverseFutilityCutoffs += s.reverseFutilityCutoffs;
+            stats.razorCutoffs += s.razorCutoffs;
+            stats.futilityPrunes += s.futilityPrunes;
+            stats.lateMovePrunes += s.lateMovePrunes;
+            stats.seePrunes += s.seePrunes;
+            stats.quietGenerations += s.quietGenerations;
+        }
+
+        if (baseTime == 0) {
+            baseTime = seconds;
+            baseNodes = nodes;
+        }
+        std::printf("%8d %10.3f %14llu %12.0f %9.2f %9.2f %8.1f%%\n", threads, seconds, nodes,
+                    seconds > 0 ? nodes / seconds : 0.0,
+                    seconds > 0 ? baseTime / seconds : 0.0,
+                    baseNodes ? double(nodes) / baseNodes : 0.0,
+                    100.0 * stats.firstMoveCutoffRate());
+        if (showStats)
+            std::printf("%8s null %llu, lmr re-search %llu, rfp %llu, razor %llu, futility %llu, lmp %llu, see %llu,"
+                        " quiet gen %llu\n", "",
+                        (unsigned long long)stats.nullMoveCutoffs, (unsigned long long)stats.lmrResearches,
+                        (unsigned long long)stats.reverseFutilityCutoffs, (unsigned long long)stats.razorCutoffs,
+                        (unsigned long long)stats.futilityPrunes, (unsigned long long)stats.lateMovePrunes,
+                        (unsigned long long)stats.seePrunes, (unsigned long long)stats.quietGenerations);
+    }
+    return 0;
+}
+
+// ----------------------------------------------
+// EVALUATION BREAKDOWN
+// ----------------------------------------------
+static int benchEval(int argc, char *argv[])
+{
+    std::vector<std::string> fens(std::begin(BenchFENs), std::end(BenchFENs));
+
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fen" && i + 1 < argc) fens.assign(1, argv[++i]);
+        else { std::printf("unknown option: %s\n", arg.c_str()); return 2; }
+    }
+
+    const int rounds = 200000;
+    for (const std::string &fen : fens) {
+        board b;
+        bool white = true;
+        if (!b.loadFEN(fen, white)) {
+            std::printf("invalid FEN: %s\n", fen.c_str());
+            return 2;
+        }
+
+        EvalBreakdown terms;
+        evaluatePosition(b, &terms);
+
+        long long sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) sink += evaluatePosition(b);
+        double seconds = secondsSince(start);
+
+        std::printf("%s\n%s  phase %d, %.0f ns/eval%s\n\n", fen.c_str(), formatEval(terms).c_str(),
+                    b.gamePhase(), seconds * 1e9 / rounds, sink == 0x7fffffff ? " " : "");
+    }
+    return 0;
+}
+
+// ----------------------------------------------
+// HEAP ALLOCATIONS IN SEARCH
+// ----------------------------------------------
+static int benchAlloc(int argc, char *argv[])
+{
+    int depth = 5;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) depth = std::atoi(argv[++i]);
+        else { std::printf("unknown option: %s\n", arg.c_str()); return 2; }
+    }
+
+    Engine engine;
+    engine.setThreads(1);
+
+    // the first search creates the thread and its stack; later ones reuse them
+    board warm;
+    bool warmWhite = true;
+    warm.loadFEN(BenchFENs[0], warmWhite);
+    SearchLimits warmLimits;
+    warmLimits.depth = 1;
+    engine.search(warm, warmWhite, warmLimits);
+
+    std::printf("%-6s %14s %12s\n", "fen", "nodes", "allocations");
+    unsigned long long total = 0;
+    int index = 0;
+    for (const char *fen : BenchFENs) {
+        board b;
+        bool white = true;
+        b.loadFEN(fen, white);
+        b.reserveHistory(Engine::MaxDepth + 1); // as a game loop would keep it; the copy must not grow
+
+        SearchLimits limits;
+        limits.depth = depth;
+        unsigned long long before = allocationCount.load();
+        engine.search(b, white, limits);
+        unsigned long long count = allocationCount.load() - before;
+        total += count;
+        std::printf("%-6d %14llu %12llu\n", ++index, (unsigned long long)engine.lastNodes(), count);
+    }
+
+    std::printf("\n%s: %llu allocations during search\n", total == 0 ? "ok" : "FAIL", total);
+    return total == 0 ? 0 : 1;
+}
+
+// ----------------------------------------------
+// STATIC EXCHANGE EVALUATION
+// ----------------------------------------------
+// Expected values use the evaluator's exchange values: P 100, N 320, B 330, R 500, Q 900
+struct SeeCase {
+    const char *fen;
+    const char *move;
+    int expected;
+};
+
+static const SeeCase SeeCases[] = {
+    // undefended pawn
+    { "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100 },
+    // NxP, NxN, RxN, BxR, QxB, QxQ: the queen behind the bishop joins by x-ray
+    { "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -220 },
+    { "4k3/8/8/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", 100 },
+    // queen takes a pawn defended by a pawn
+    { "4k3/8/2p5/3p4/8/8/3Q4/4K3 w - - 0 1", "d2d5", -800 },
+    // doubled rooks: the second rook recaptures through the first
+    { "3rk3/8/8/3p4/8/8/3R4/3RK3 w - - 0 1", "d2d5", 100 },
+    { "3rk3/8/8/3p4/8/8/8/3RK3 w - - 0 1", "d1d5", -400 },
+    // the king may recapture only when nothing can take back
+    { "8/8/8/3p4/4k3/8/8/3RK3 w - - 0 1", "d1d5", -400 },
+    { "3R4/8/8/3p4/4k3/8/8/3RK3 w - - 0 1", "d1d5", 100 },
+    // en passant
+    { "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 100 },
+    // capture-promotions, free and answered by the king
+    { "1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 1300 },
+    { "1r6/P1k5/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", 400 },
+    // quiet moves: a safe square and one covered by a pawn
+    { "4k3/8/2p5/8/8/2N5/8/4K3 w - - 0 1", "c3e4", 0 },
+    { "4k3/8/2p5/8/8/2N5/8/4K3 w - - 0 1", "c3d5", -320 },
+    // black to move: BxN, PxB
+    { "4k3/8/3b4/8/5N2/4P3/8/4K3 b - - 0 1", "d6f4", -10 },
+};
+
+static int benchSee(int argc, char *argv[])
+{
+    if (argc > 0) { std::printf("unknown option: %s\n", argv[0]); return 2; }
+
+    int failures = 0;
+    for (const SeeCase &c : SeeCases) {
+        board b;
+        bool white = true;
+        PackedMove m;
+        if (!b.loadFEN(c.fen, white) || !b.parseMove(c.move, white, m)) {
+            std::printf("bad case: %s %s\n", c.fen, c.move);
+            ++failures;
+            continue;
+        }
+        int value = b.see(m);
+        bool ok = value == c.expected;
+        if (!ok) ++failures;
+        std::printf("%-6s %6d %6d  %s  %s\n", c.move, value, c.expected, ok ? "ok  " : "FAIL", c.fen);
+    }
+
+    // timing over the captures of the bench positions
+    const int rounds = 20000;
+    long long sink = 0, calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const char *fen : BenchFENs) {
+        board b;
+        bool white = true;
+        b.loadFEN(fen, white);
+        MoveList captures;
+        b.legalCaptures(captures, white);
+        for (int i = 0; i < rounds; ++i)
+            for (PackedMove m : captures) sink += b.see(m);
+        calls += (long long)rounds * captures.size();
+    }
+    double seconds = secondsSince(start);
+
+    std::printf("\n%d failure(s); %lld calls, %.1f ns/see%s\n", failures, calls,
+                calls ? seconds * 1e9 / calls : 0.0, sink == 0x7fffffff ? " " : "");
+    return failures ? 1 : 0;
+}
+
+// ----------------------------------------------
+// Draw detection
+// ----------------------------------------------
+// `moves` are played from `fen` first, so the game history holds the position
+// after `repeat`. The side behind must take the draw by playing it again; the
+// side ahead must play something else and keep its advantage.
+struct DrawCase {
+    const char *fen;
+    const char *moves;
+    const char *repeat;     // move back into a position already seen; empty: none
+    bool takeDraw;          // expected: play `repeat` (or any move, without it) for 0
+};
+
+static const DrawCase DrawCases[] = {
+    // a queen and rook against a queen: shuffling back repeats
+    { "rq4k1/5ppp/8/8/8/8/5PPP/3Q2K1 w - - 0 1", "d1d2 g8h8 d2d1 h8g8", "d1d2", true },
+    // the same shuffle a rook up: the repetition is avoided
+    { "6k1/5pp1/7p/8/8/8/5PPP/R2Q2K1 w - - 0 1", "d1d2 g8h7 d2d1 h7g8", "d1d2", false },
+    // 99 reversible moves played: every quiet move draws by the fifty-move rule
+    { "rq4k1/5ppp/8/8/8/8/6PP/3Q2K1 w - - 99 80", "", "", true },
+};
+
+static int benchDraw(int argc, char *argv[])
+{
+    if (argc > 0) { std::printf("unknown option: %s\n", argv[0]); return 2; }
+
+    int failures = 0;
+    for (const DrawCase &c : DrawCases) {
+        board b;
+        bool white = true;
+        bool valid = b.loadFEN(c.fen, white);
+        std::istringstream moves(c.moves);
+        for (std::string text; valid && moves >> text;) {
+            PackedMove m;
+            valid = b.parseMove(text, white, m);
+            if (valid) {
+                b.makeMove(m);
+                white = !white;
+            }
+        }
+        if (!valid) {
+            std::printf("bad case: %s %s\n", c.fen, c.moves);
+            ++failures;
+            continue;
+        }
+
+        Engine engine;
+        int score = 0;
+        engine.setInfoCallback([&score](const SearchInfo &info) { score = info.score; });
+        SearchLimits limits;
+        limits.depth = 8;
+        const std::string best = board::moveToString(engine.search(b, white, limits));
+
+        const bool repeated = best == c.repeat;
+        const bool ok = c.takeDraw ? score == 0 && (!*c.repeat || repeated) : score > 0 && !repeated;
+        if (!ok) ++failures;
+        std::printf("%-6s %6d  %s  %s\n", best.c_str(), score, ok ? "ok  " : "FAIL", c.fen);
+    }
+
+    std::printf("\n%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
+
+static void usage()
+{
+    std::printf("usage: bench smp [--depth N] [--hash MB] [--large-pages] [--threads 1,2,4,8,16] [--no-null]\n"
+                "                 [--no-lmr] [--stats]\n"
+                "       bench eval [--fen \"<FEN>\"]\n"
+                "       bench alloc [--depth N]\n"
+                "       bench see\n"
+                "       bench draw\n");
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) { usage(); return 2; }
+
+    std::string command = argv[1];
+    std::printf("%s\n", Engine::info().c_str());
+
+    if (command == "smp") return benchSmp(argc - 2, argv + 2);
+    if (command == "eval") return benchEval(argc - 2, argv + 2);
+    if (command == "alloc") return benchAlloc(argc - 2, argv + 2);
+    if (command == "see") return benchSee(argc - 2, argv + 2);
+    if (command == "draw") return benchDraw(argc - 2, argv + 2);
+
+    usage();
+    return 2;
+}
@@ -0,0 +1,251 @@
+#include "bitboard.h"
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(CHESS_X86_KERNELS) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+CpuKernel ActiveKernel = CpuKernel::Portable;
+
+Bitboard KnightAttacks[64];
+Bitboard KingAttacks[64];
+Bitboard PawnAttacks[2][64];
+
+Magic RookMagics[64];
+Magic BishopMagics[64];
+
+Bitboard BetweenBB[64][64];
+Bitboard LineBB[64][64];
+
+// Shared attack storage: the sum over all squares of 2^(relevant bits).
+static Bitboard RookTable[0x19000];
+static Bitboard BishopTable[0x1480];
+
+namespace {
+
+const int RookDirs[4][2]   = { {1,0}, {-1,0}, {0,1}, {0,-1} };
+const int BishopDirs[4][2] = { {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+
+bool onBoard(int r, int c) { return r >= 0 && r < 8 && c >= 0 && c < 8; }
+
+// Slow ray walk, only used while building the tables.
+Bitboard slidingAttacks(const int dirs[4][2], int sq, Bitboard occ)
+{
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; ++d) {
+        int r = rowOf(sq) + dirs[d][0];
+        int c = colOf(sq) + dirs[d][1];
+        while (onBoard(r, c)) {
+            Bitboard b = squareBB(squareOf(r, c));
+            attacks |= b;
+            if (occ & b) break;
+            r += dirs[d][0];
+            c += dirs[d][1];
+        }
+    }
+    return attacks;
+}
+
+// Occupancy bits that can affect a slider on `sq`: the rays minus the board edge.
+Bitboard relevantMask(const int dirs[4][2], int sq)
+{
+    Bitboard mask = 0;
+    for (int d = 0; d < 4; ++d) {
+        int r = rowOf(sq) + dirs[d][0];
+        int c = colOf(sq) + dirs[d][1];
+        while (onBoard(r + dirs[d][0], c + dirs[d][1])) {
+            mask |= squareBB(squareOf(r, c));
+            r += dirs[d][0];
+            c += dirs[d][1];
+        }
+    }
+    return mask;
+}
+
+// Magic multipliers for this square layout, found offline with a sparse-random
+// search (no destructive collisions at the minimal table size).
+const Bitboard RookMagicNumbers[64] = {
+    0x0480046281400010ULL, 0x1040100040002002ULL, 0x8780200008300180ULL, 0x8880060800100080ULL,
+    0x8200020104100820ULL, 0x0200100104020008ULL, 0x0480010000800200ULL, 0x4E00008201005024ULL,
+    0x1000800080400020ULL, 0x0080401000402001ULL, 0x0104802002801000ULL, 0x4401808010003800ULL,
+    0x8001801801140080ULL, 0x0002000810020004ULL, 0x0002004402004108ULL, 0x0011800300004180ULL,
+    0x4540008020408006ULL, 0x0000404000201001ULL, 0x7D10010100200040ULL, 0x1380808008001002ULL,
+    0x4408010005000810ULL, 0x0012008080020400ULL, 0x0002040002081001ULL, 0x102202000444810CULL,
+    0x0100400080208001ULL, 0x4800400140201002ULL, 0x1060100080200082ULL, 0x00E0100080080084ULL,
+    0x0001000500080010ULL, 0x4002000600100419ULL, 0x0000020400104108ULL, 0x4805800080004100ULL,
+    0x0280002001400240ULL, 0xA010002000400040ULL, 0x0430124103002000ULL, 0x02820A0042002010ULL,
+    0x0131001005000800ULL, 0x0C01000401000208ULL, 0x8102010204001008ULL, 0x0802004092001104ULL,
+    0x4C40004020808002ULL, 0x4410500420024000ULL, 0x00C0100020008080ULL, 0x0000100008008080ULL,
+    0x0004008008008004ULL, 0x0802000804010100ULL, 0x0001011002040008ULL, 0x00330044008A0009ULL,
+    0x1000400280022480ULL, 0x0840004880200880ULL, 0x0000200080100080ULL, 0x8044080480100080ULL,
+    0x0100040080080080ULL, 0x2084010002004040ULL, 0x0040020850410400ULL, 0x000900A114084200ULL,
+    0x00008002204A1101ULL, 0x0801004000201081ULL, 0x4300C0200011000DULL, 0x1385002008041001ULL,
+    0x140A0084A0181032ULL, 0x040300040018020DULL, 0x0000280201009004ULL, 0x0003000208902041ULL
+};
+
+const Bitboard BishopMagicNumbers[64] = {
+    0x48081010008A2A80ULL, 0x0102C40404821100ULL, 0x0021480880800180ULL, 0x0004504201800180ULL,
+    0x0004042111103108ULL, 0xC242086208200204ULL, 0x1000640220900350ULL, 0x10008020901008C4ULL,
+    0x0000312208080880ULL, 0x0220021002009900ULL, 0x0802120C24082080ULL, 0x0044110404810900ULL,
+    0x40002848400A0000ULL, 0x2020409004201400ULL, 0x1000020804028830ULL, 0x0008002414040491ULL,
+    0x0008403429080820ULL, 0x0108001090209080ULL, 0x6424084043060030ULL, 0x88A8103404208810ULL,
+    0x0014004210140404ULL, 0x800A000101010148ULL, 0x0001004411180200ULL, 0x1000408101080121ULL,
+    0x0008068340104200ULL, 0x0112110008110800ULL, 0x042808200C004110ULL, 0x4048080004820002ULL,
+    0x2001010000104000ULL, 0x000C024008081A00ULL, 0x0404040025108214ULL, 0x2000404001010802ULL,
+    0x0041041381202000ULL, 0x01008C1005601680ULL, 0x01D010900002040AULL, 0x4040020080080080ULL,
+    0x00050A0400820102ULL, 0x8018820080041000ULL, 0xC2014101200A0802ULL, 0x0108061042308052ULL,
+    0x8004020242201020ULL, 0x08A1008884122030ULL, 0x0202010028020480ULL, 0x5080008401001020ULL,
+    0x8820204410400400ULL, 0x0020020041100200ULL, 0x0844504200400201ULL, 0x1882480200800020ULL,
+    0xC002080404040400ULL, 0x0382004108292000ULL, 0xA005020442088020ULL, 0x2000042820880310ULL,
+    0x0803008821011400ULL, 0x4086080218420420ULL, 0x00B0200282860400ULL, 0x1088880100420028ULL,
+    0x1030820110010500ULL, 0x0080012608025800ULL, 0x0002810084008800ULL, 0x8009001800420200ULL,
+    0x000B000010021202ULL, 0x433080C0104C0120ULL, 0x0002906048112040ULL, 0x40106000A1160020ULL
+};
+
+void initMagics(const int dirs[4][2], const Bitboard numbers[64], Magic magics[64], Bitboard *table)
+{
+    for (int sq = 0; sq < 64; ++sq) {
+        Magic &m = magics[sq];
+        m.mask = relevantMask(dirs, sq);
+        m.magic = numbers[sq];
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = (sq == 0) ? table : magics[sq - 1].attacks + (1u << (64 - magics[sq - 1].shift));
+
+        // enumerate every subset of the mask (Carry-Rippler) and store its attack set
+        Bitboard b = 0;
+        do {
+            m.attacks[m.index(b)] = slidingAttacks(dirs, sq, b);
+            b = (b - m.mask) & m.mask;
+        } while (b);
+    }
+}
+
+void initLeaperTables()
+{
+    const int knight[8][2] = {{2,1},{2,-1},{-2,1},{-2,-1},{1,2},{1,-2},{-1,2},{-1,-2}};
+
+    for (int sq = 0; sq < 64; ++sq) {
+        int r = rowOf(sq), c = colOf(sq);
+
+        KnightAttacks[sq] = 0;
+        for (auto &d : knight)
+            if (onBoard(r + d[0], c + d[1]))
+                KnightAttacks[sq] |= squareBB(squareOf(r + d[0], c + d[1]));
+
+        KingAttacks[sq] = 0;
+        for (int dr = -1; dr <= 1; ++dr)
+            for (int dc = -1; dc <= 1; ++dc)
+                if ((dr || dc) && onBoard(r + dr, c + dc))
+                    KingAttacks[sq] |= squareBB(squareOf(r + dr, c + dc));
+
+        // white pawns move towards row 0, black pawns towards row 7
+        PawnAttacks[1][sq] = PawnAttacks[0][sq] = 0;
+        for (int dc : {-1, 1}) {
+            if (onBoard(r - 1, c + dc)) PawnAttacks[1][sq] |= squareBB(squareOf(r - 1, c + dc));
+            if (onBoard(r + 1, c + dc)) PawnAttacks[0][sq] |= squareBB(squareOf(r + 1, c + dc));
+        }
+    }
+}
+
+// Needs the slider tables, so runs after initMagics.
+void initLineTables()
+{
+    for (int s1 = 0; s1 < 64; ++s1) {
+        for (int s2 = 0; s2 < 64; ++s2) {
+            BetweenBB[s1][s2] = LineBB[s1][s2] = 0;
+            if (s1 == s2) continue;
+
+            Bitboard ends = squareBB(s1) | squareBB(s2);
+            if (rookAttacks(s1, 0) & squareBB(s2)) {
+                LineBB[s1][s2] = (rookAttacks(s1, 0) & rookAttacks(s2, 0)) | ends;
+                BetweenBB[s1][s2] = rookAttacks(s1, squareBB(s2)) & rookAttacks(s2, squareBB(s1));
+            } else if (bishopAttacks(s1, 0) & squareBB(s2)) {
+                LineBB[s1][s2] = (bishopAttacks(s1, 0) & bishopAttacks(s2, 0)) | ends;
+                BetweenBB[s1][s2] = bishopAttacks(s1, squareBB(s2)) & bishopAttacks(s2, squareBB(s1));
+            }
+        }
+    }
+}
+
+// cpuid probe. AMD parts before Zen 3 implement PEXT in microcode (hundreds of
+// cycles), so they are treated as POPCNT-only.
+CpuKernel detectCpuKernel()
+{
+#ifdef CHESS_X86_KERNELS
+    unsigned regs[4] = {0, 0, 0, 0};   // eax, ebx, ecx, edx
+    auto cpuid = [&](unsigned leaf) {
+#if defined(_MSC_VER)
+        int r[4];
+        __cpuidex(r, (int)leaf, 0);
+        for (int i = 0; i < 4; ++i) regs[i] = (unsigned)r[i];
+#else
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    };
+
+    cpuid(0);
+    unsigned maxLeaf = regs[0];
+    char vendor[13] = {};
+    std::memcpy(vendor, &regs[1], 4);
+    std::memcpy(vendor + 4, &regs[3], 4);
+    std::memcpy(vendor + 8, &regs[2], 4);
+
+    cpuid(1);
+    bool hasPopcnt = (regs[2] >> 23) & 1;
+    unsigned family = ((regs[0] >> 8) & 0xF) + ((regs[0] >> 20) & 0xFF);
+
+    bool hasBmi2 = false;
+    if (maxLeaf >= 7) {
+        cpuid(7);
+        hasBmi2 = (regs[1] >> 8) & 1;
+    }
+    bool slowPext = std::strcmp(vendor, "AuthenticAMD") == 0 && family < 0x19;
+
+    if (hasBmi2 && hasPopcnt && !slowPext) return CpuKernel::Pext;
+    if (hasPopcnt) return CpuKernel::Popcnt;
+#endif
+    return CpuKernel::Portable;
+}
+
+CpuKernel selectCpuKernel()
+{
+    CpuKernel best = detectCpuKernel();
+
+    // optional override, used to test and time the slower paths on one host
+    if (const char *env = std::getenv("CHESS_KERNEL")) {
+        for (CpuKernel k : { CpuKernel::Portable, CpuKernel::Popcnt, CpuKernel::Pext })
+            if (std::strcmp(env, cpuKernelName(k)) == 0 && k <= best)
+                return k;
+    }
+    return best;
+}
+
+bool buildTables()
+{
+    ActiveKernel = selectCpuKernel();
+    initLeaperTables();
+    initMagics(RookDirs, RookMagicNumbers, RookMagics, RookTable);
+    initMagics(BishopDirs, BishopMagicNumbers, BishopMagics, BishopTable);
+    initLineTables();
+    return true;
+}
+
+} // namespace
+
+void initAttackTables()
+{
+    // function-local static: built exactly once, thread-safe since C++11
+    static const bool built = buildTables();
+    (void)built;
+}
+
+const char *cpuKernelName(CpuKernel k)
+{
+    switch (k) {
+    case CpuKernel::Pext:   return "pext";
+    case CpuKernel::Popcnt: return "popcnt";
+    default:                return "portable";
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#define CHESS_X86_KERNELS 1
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CHESS_X86_KERNELS 1
+#endif
+
+typedef std::uint64_t Bitboard;
+
+// Squares are numbered row * 8 + col, where row 0 is black's back rank (rank 8)
+// and col 0 is the a-file. This is the same layout the UI uses for its 8x8 grid.
+constexpr int squareOf(int row, int col) { return row * 8 + col; }
+inline int rowOf(int sq) { return sq >> 3; }
+inline int colOf(int sq) { return sq & 7; }
+inline Bitboard squareBB(int sq) { return Bitboard(1) << sq; }
+
+// index of the least significant set bit (b must be non-zero)
+inline int lsb(Bitboard b)
+{
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return (int)idx;
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+// pops the least significant set bit and returns its index
+inline int popLsb(Bitboard &b)
+{
+    int sq = lsb(b);
+    b &= b - 1;
+    return sq;
+}
+
+// --- CPU kernels -----------------------------------------------------------
+// Bit counting and slider-table indexing each have a portable version and a
+// hardware version (POPCNT, BMI2 PEXT). One build runs on every x86-64 host:
+// the instructions are emitted directly and only executed when cpuid reports
+// them, so no -march flag is needed. The kernel is fixed by initAttackTables()
+// before the slider tables are built, since PEXT and magics index differently.
+enum class CpuKernel { Portable, Popcnt, Pext };
+
+extern CpuKernel ActiveKernel;
+const char *cpuKernelName(CpuKernel k);
+
+// portable population count (SWAR)
+inline int popCountPortable(Bitboard b)
+{
+    b = b - ((b >> 1) & 0x5555555555555555ULL);
+    b = (b & 0x3333333333333333ULL) + ((b >> 2) & 0x3333333333333333ULL);
+    b = (b + (b >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((b * 0x0101010101010101ULL) >> 56);
+}
+
+#ifdef CHESS_X86_KERNELS
+inline int popCountHardware(Bitboard b)
+{
+#if defined(_MSC_VER)
+    return (int)__popcnt64(b);
+#else
+    Bitboard r;
+    __asm__("popcntq %1, %0" : "=r"(r) : "r"(b));
+    return (int)r;
+#endif
+}
+
+inline Bitboard pextHardware(Bitboard src, Bitboard mask)
+{
+#if defined(_MSC_VER)
+    return _pext_u64(src, mask);
+#else
+    Bitboard r;
+    __asm__("pextq %2, %1, %0" : "=r"(r) : "r"(src), "r"(mask));
+    return r;
+#endif
+}
+#endif
+
+inline int popCount(Bitboard b)
+{
+#ifdef CHESS_X86_KERNELS
+    if (ActiveKernel != CpuKernel::Portable)
+        return popCountHardware(b);
+#endif
+    return popCountPortable(b);
+}
+
+// --- precomputed attack tables ---------------------------------------------
+// Filled once by initAttackTables(); every lookup below is O(1).
+extern Bitboard KnightAttacks[64];
+extern Bitboard KingAttacks[64];
+extern Bitboard PawnAttacks[2][64];   // [white][square] - squares a pawn attacks
+
+// Magic-bitboard entry for one slider square: the relevant-occupancy mask is
+// multiplied by the magic and the top bits index a shared attack table.
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard *attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occ) const {
+#ifdef CHESS_X86_KERNELS
+        if (ActiveKernel == CpuKernel::Pext)
+            return unsigned(pextHardware(occ, mask));
+#endif
+        return unsigned(((occ & mask) * magic) >> shift);
+    }
+};
+
+extern Magic RookMagics[64];
+extern Magic BishopMagics[64];
+
+// Square-pair geometry: BetweenBB holds the squares strictly between two squares
+// on a shared rank, file or diagonal; LineBB the whole line through both. Both
+// are empty when the squares are not aligned.
+extern Bitboard BetweenBB[64][64];
+extern Bitboard LineBB[64][64];
+
+// Picks the CPU kernel and builds all tables. Safe to call more than once; only
+// the first call does work. Setting CHESS_KERNEL=portable|popcnt|pext in the
+// environment forces a slower kernel (an unsupported one is ignored).
+void initAttackTables();
+
+inline Bitboard knightAttacks(int sq) { return KnightAttacks[sq]; }
+inline Bitboard kingAttacks(int sq) { return KingAttacks[sq]; }
+inline Bitboard pawnAttacks(bool white, int sq) { return PawnAttacks[white][sq]; }
+
+inline Bitboard rookAttacks(int sq, Bitboard occ)
+{
+    const Magic &m = RookMagics[sq];
+    return m.attacks[m.index(occ)];
+}
+
+inline Bitboard bishopAttacks(int sq, Bitboard occ)
+{
+    const Magic &m = BishopMagics[sq];
+    return m.attacks[m.index(occ)];
+}
+
+inline Bitboard queenAttacks(int sq, Bitboard occ)
+{
+    return rookAttacks(sq, occ) | bishopAttacks(sq, occ);
+}
+
+#endif // BITBOARD_H
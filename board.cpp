@@ -1,14 +1,59 @@
 #include "board.h"
+#include "psqt.h"
 #include <algorithm>
+#include <cstring>
+#include <sstream>
+
+// --- Zobrist keys ----------------------------------------------------------
+// One random key per (piece, square), for black to move, for each castling-rights
+// mask and for each en-passant file. Generated once with a fixed seed.
+namespace {
+
+struct ZobristKeys {
+    std::uint64_t piece[13][64];   // EMPTY row stays zero
+    std::uint64_t side;
+    std::uint64_t castling[16];
+    std::uint64_t epFile[8];
+
+    ZobristKeys() {
+        std::uint64_t s = 0x2545F4914F6CDD1DULL;
+        auto next = [&s]() {   // xorshift64*
+            s ^= s >> 12; s ^= s << 25; s ^= s >> 27;
+            return s * 2685821657736338717ULL;
+        };
+        for (int sq = 0; sq < 64; ++sq) piece[EMPTY][sq] = 0;
+        for (int p = BQ; p <= WB; ++p)
+            for (int sq = 0; sq < 64; ++sq) piece[p][sq] = next();
+        side = next();
+        for (auto &k : castling) k = next();
+        for (auto &k : epFile) k = next();
+    }
+};
+
+const ZobristKeys Zobrist;
+
+// Castling rights lost when a move starts or ends on `sq` (king or rook home
+// squares); covers both moving the piece and having the rook captured.
+int castlingRightsLost(int sq) {
+    switch (sq) {
+    case squareOf(7, 4): return board::WhiteOO | board::WhiteOOO;
+    case squareOf(7, 7): return board::WhiteOO;
+    case squareOf(7, 0): return board::WhiteOOO;
+    case squareOf(0, 4): return board::BlackOO | board::BlackOOO;
+    case squareOf(0, 7): return board::BlackOO;
+    case squareOf(0, 0): return board::BlackOOO;
+    default: return 0;
+    }
+}
+
+} // namespace
+
+board::board() {
+    initAttackTables();
+    initPsqt();
 
-board::board():CurrentState(8, std::vector<Piece>(8, EMPTY)) {
     // initialize castling rights
-    whiteKingMoved = false;
-    blackKingMoved = false;
-    whiteLeftRookMoved = false;
-    whiteRightRookMoved = false;
-    blackLeftRookMoved = false;
-    blackRightRookMoved = false;
+    castling = WhiteOO | WhiteOOO | BlackOO | BlackOOO;
 
     // en-passant target inactive
     enPassantTarget = {-1, -1};
@@ -17,731 +62,814 @@ board::board():CurrentState(8, std::vector<Piece>(8, EMPTY)) {
 }
 
 void board::reset_board() {
-    // First, fill everything with EMPTY
-    for (auto &row : CurrentState)
-        std::fill(row.begin(), row.end(), EMPTY);
+    // First, clear every square and bitboard
+    clearPieces();
 
     // --- Black pieces ---
-    CurrentState[0] = { BR, BN, BB, BQ, BK, BB, BN, BR };  // Back rank
-    CurrentState[1] = { BP, BP, BP, BP, BP, BP, BP, BP };  // Pawns
-
-    // --- Empty rows ---
-    for (int i = 2; i <= 5; ++i)
-        std::fill(CurrentState[i].begin(), CurrentState[i].end(), EMPTY);
-
+    const Piece blackBack[8] = { BR, BN, BB, BQ, BK, BB, BN, BR };  // Back rank
     // --- White pieces ---
-    CurrentState[6] = { WP, WP, WP, WP, WP, WP, WP, WP };  // Pawns
-    CurrentState[7] = { WR, WN, WB, WQ, WK, WB, WN, WR };  // Back rank
+    const Piece whiteBack[8] = { WR, WN, WB, WQ, WK, WB, WN, WR };  // Back rank
+
+    for (int c = 0; c < 8; ++c) {
+        putPiece(blackBack[c], squareOf(0, c));
+        putPiece(BP, squareOf(1, c));   // Pawns
+        putPiece(WP, squareOf(6, c));   // Pawns
+        putPiece(whiteBack[c], squareOf(7, c));
+    }
 
     // Reset castling rights (fresh game)
-    whiteKingMoved = false;
-    blackKingMoved = false;
-    whiteLeftRookMoved = false;
-    whiteRightRookMoved = false;
-    blackLeftRookMoved = false;
-    blackRightRookMoved = false;
-
-    // Reset en-passant target
+    castling = WhiteOO | WhiteOOO | BlackOO | BlackOOO;
+    zobristKey ^= Zobrist.castling[castling];
+
+    // Reset en-passant target, clocks and repetition history
     enPassantTarget = {-1, -1};
+    halfMoveClock = 0;
+    undoStack.clear();
+    undoStack.reserve(512);
 }
 
 void board::update_board(){
     // currently unused — keep for future use
 }
 
-bool board::isInsideBoard(int r, int c) {
-    return r >= 0 && r < 8 && c >= 0 && c < 8;
+// --- square / bitboard bookkeeping -----------------------------------------
+// Every change to the position goes through these three helpers so that the
+// square array, the piece bitboards and the occupancy unions never disagree.
+void board::clearPieces() {
+    std::fill(std::begin(squares), std::end(squares), EMPTY);
+    std::memset(pieceBB, 0, sizeof(pieceBB));
+    std::memset(colorBB, 0, sizeof(colorBB));
+    occupiedBB = 0;
+    zobristKey = 0;
+    psqtMg = psqtEg = phase = 0;
 }
 
-bool board::isWhitePiece(Piece p) {
-    return p == WP || p == WR || p == WN || p == WB || p == WQ || p == WK;
+void board::putPiece(Piece p, int sq) {
+    Bitboard b = squareBB(sq);
+    squares[sq] = p;
+    pieceBB[p] |= b;
+    colorBB[isWhitePiece(p)] |= b;
+    occupiedBB |= b;
+    zobristKey ^= Zobrist.piece[p][sq];
+    psqtMg += PsqtMg[p][sq];
+    psqtEg += PsqtEg[p][sq];
+    phase += PhaseWeight[p];
 }
 
-bool board::isBlackPiece(Piece p) {
-    return p == BP || p == BR || p == BN || p == BB || p == BQ || p == BK;
+void board::removePiece(int sq) {
+    Piece p = squares[sq];
+    if (p == EMPTY) return;
+    Bitboard b = ~squareBB(sq);
+    pieceBB[p] &= b;
+    colorBB[isWhitePiece(p)] &= b;
+    occupiedBB &= b;
+    zobristKey ^= Zobrist.piece[p][sq];
+    psqtMg -= PsqtMg[p][sq];
+    psqtEg -= PsqtEg[p][sq];
+    phase -= PhaseWeight[p];
+    squares[sq] = EMPTY;
 }
 
-std::vector<std::pair<int, int>> board::getLegalMoves(int row, int col) {
-    // PSEUDO-LEGAL moves only. Do NOT call isKingInCheck() here.
-    std::vector<std::pair<int, int>> moves;
-    if (!isInsideBoard(row, col)) return moves;
-
-    Piece piece = CurrentState[row][col];
-    if (piece == EMPTY) return moves;
-
-    // Helper lambda to add capture or empty square if valid
-    auto tryAdd = [&](int r, int c, bool allowCapture, bool allowEmpty){
-        if (!isInsideBoard(r,c)) return;
-        Piece targ = CurrentState[r][c];
-        if (targ == EMPTY && allowEmpty) moves.emplace_back(r,c);
-        else if (targ != EMPTY && allowCapture) {
-            // only capture opposite-color pieces
-            if (isWhitePiece(piece) && isBlackPiece(targ)) moves.emplace_back(r,c);
-            if (isBlackPiece(piece) && isWhitePiece(targ)) moves.emplace_back(r,c);
-        }
-    };
-
-    // Pawn moves
-    if (piece == WP || piece == BP) {
-        bool isWhite = isWhitePiece(piece);
-        int dir = isWhite ? -1 : 1;
-        int startRow = isWhite ? 6 : 1;
-        int oneR = row + dir;
-
-        // Forward one
-        if (isInsideBoard(oneR, col) && CurrentState[oneR][col] == EMPTY)
-            moves.emplace_back(oneR, col);
-
-        // Forward two from starting rank
-        int twoR = row + 2*dir;
-        if (row == startRow && isInsideBoard(oneR, col) && CurrentState[oneR][col] == EMPTY
-            && isInsideBoard(twoR, col) && CurrentState[twoR][col] == EMPTY)
-            moves.emplace_back(twoR, col);
-
-        // Captures (only existing pieces here - en-passant handled separately in getAllLegalMoves)
-        for (int dc : {-1, 1}) {
-            int cr = row + dir, cc = col + dc;
-            if (!isInsideBoard(cr,cc)) continue;
-            Piece targ = CurrentState[cr][cc];
-            if (targ != EMPTY) {
-                if (isWhite && isBlackPiece(targ)) moves.emplace_back(cr,cc);
-                if (!isWhite && isWhitePiece(targ)) moves.emplace_back(cr,cc);
-            }
-        }
+void board::movePiece(int from, int to) {
+    Piece p = squares[from];
+    removePiece(from);
+    putPiece(p, to);
+}
 
-        // Note: en-passant and promotion handled later in getAllLegalMoves
-        return moves;
-    }
+int board::psqtScore() const {
+    return taperedScore(psqtMg, psqtEg, phase);
+}
 
-    // Knight moves
-    if (piece == WN || piece == BN) {
-        const int kd[8][2] = {{2,1},{2,-1},{-2,1},{-2,-1},{1,2},{1,-2},{-1,2},{-1,-2}};
-        for (auto &d : kd) {
-            int nr = row + d[0], nc = col + d[1];
-            if (!isInsideBoard(nr,nc)) continue;
-            Piece targ = CurrentState[nr][nc];
-            if (targ == EMPTY) moves.emplace_back(nr,nc);
-            else {
-                if (isWhitePiece(piece) && isBlackPiece(targ)) moves.emplace_back(nr,nc);
-                if (isBlackPiece(piece) && isWhitePiece(targ)) moves.emplace_back(nr,nc);
-            }
-        }
-        return moves;
+void board::computePsqt(int &mg, int &eg, int &phaseOut) const {
+    mg = eg = phaseOut = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        Piece p = squares[sq];
+        mg += PsqtMg[p][sq];
+        eg += PsqtEg[p][sq];
+        phaseOut += PhaseWeight[p];
     }
+}
 
-    // Sliding pieces: rook, bishop, queen
-    auto slide = [&](const std::vector<std::pair<int,int>>& dirs) {
-        for (auto d : dirs) {
-            int dr = d.first, dc = d.second;
-            int nr = row + dr, nc = col + dc;
-            while (isInsideBoard(nr,nc)) {
-                Piece targ = CurrentState[nr][nc];
-                if (targ == EMPTY) {
-                    moves.emplace_back(nr,nc);
-                } else {
-                    // can capture opponent
-                    if ( (isWhitePiece(piece) && isBlackPiece(targ)) ||
-                        (isBlackPiece(piece) && isWhitePiece(targ)) ) {
-                        moves.emplace_back(nr,nc);
-                    }
-                    break; // blocked beyond capture or own piece
-                }
-                nr += dr; nc += dc;
-            }
-        }
-    };
-
-    if (piece == WR || piece == BR) {
-        std::vector<std::pair<int,int>> rookDirs = {{1,0},{-1,0},{0,1},{0,-1}};
-        slide(rookDirs);
-        return moves;
+// --- makeMove / unmakeMove --------------------------------------------------
+// The previous key, castling rights, en-passant square, clock and captured
+// piece go on the undo stack; unmakeMove puts the pieces back and restores
+// the rest from there.
+void board::makeMove(PackedMove m) {
+    const int from = m.from();
+    const int to = m.to();
+    const Piece p = squares[from];
+    const bool white = isWhitePiece(p);
+
+    UndoInfo u;
+    u.key = zobristKey;
+    u.captured = squares[to];
+    u.castling = std::uint8_t(castling);
+    u.epSquare = std::int8_t(enPassantTarget.first == -1 ? -1 : squareOf(enPassantTarget.first, enPassantTarget.second));
+    u.halfMoveClock = halfMoveClock;
+
+    switch (m.kind()) {
+    case PackedMove::EnPassant: {
+        // the captured pawn sits behind the target square
+        const int capSq = to + (white ? 8 : -8);
+        u.captured = squares[capSq];
+        removePiece(capSq);
+        movePiece(from, to);
+        break;
     }
-
-    if (piece == WB || piece == BB) {
-        std::vector<std::pair<int,int>> bishopDirs = {{1,1},{1,-1},{-1,1},{-1,-1}};
-        slide(bishopDirs);
-        return moves;
+    case PackedMove::Castling:
+        movePiece(from, to);
+        if (to > from) movePiece(to + 1, to - 1);   // king-side: h-file rook to the f-file
+        else movePiece(to - 2, to + 1);             // queen-side: a-file rook to the d-file
+        break;
+    case PackedMove::Promotion:
+        removePiece(to);
+        removePiece(from);
+        putPiece(m.promotion(white), to);
+        break;
+    default:
+        removePiece(to);
+        movePiece(from, to);
+        break;
     }
+    undoStack.push_back(u);
 
-    if (piece == WQ || piece == BQ) {
-        std::vector<std::pair<int,int>> queenDirs = {{1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}};
-        slide(queenDirs);
-        return moves;
-    }
+    // ---- 50-MOVE RULE CLOCK: pawn move or capture resets it ----
+    if (p == WP || p == BP || u.captured != EMPTY)
+        halfMoveClock = 0;
+    else
+        halfMoveClock += 1;
 
-    if (piece == WK || piece == BK) {
-        for (int dr = -1; dr <= 1; ++dr) {
-            for (int dc = -1; dc <= 1; ++dc) {
-                if (dr == 0 && dc == 0) continue;
-                int nr = row + dr, nc = col + dc;
-                if (!isInsideBoard(nr,nc)) continue;
-                Piece targ = CurrentState[nr][nc];
-                if (targ == EMPTY) moves.emplace_back(nr,nc);
-                else {
-                    if (isWhitePiece(piece) && isBlackPiece(targ)) moves.emplace_back(nr,nc);
-                    if (isBlackPiece(piece) && isWhitePiece(targ)) moves.emplace_back(nr,nc);
-                }
-            }
+    // ---- EN-PASSANT TARGET: only right after a pawn double-step ----
+    // and only if an enemy pawn can take, so positions that differ in nothing
+    // else share a key (loadFEN applies the same rule)
+    if (enPassantTarget.first != -1) zobristKey ^= Zobrist.epFile[enPassantTarget.second];
+    enPassantTarget = {-1, -1};
+    if ((p == WP || p == BP) && std::abs(to - from) == 16) {
+        const int passed = (from + to) / 2;
+        if (pawnAttacks(p == WP, passed) & pieceBB[p == WP ? BP : WP]) {
+            enPassantTarget = {rowOf(passed), colOf(passed)};
+            zobristKey ^= Zobrist.epFile[colOf(passed)];
         }
+    }
 
-        // CASTLING IS DELIBERATELY NOT HANDLED HERE (keep pseudo-legal)
-        return moves;
+    // ---- CASTLING RIGHTS ----
+    // Touching a king or rook home square (moving from it or capturing on it) drops the matching rights.
+    int lost = castlingRightsLost(from) | castlingRightsLost(to);
+    if (castling & lost) {
+        zobristKey ^= Zobrist.castling[castling];
+        castling &= ~lost;
+        zobristKey ^= Zobrist.castling[castling];
     }
 
-    return moves;
+    // ---- SIDE TO MOVE ----
+    zobristKey ^= Zobrist.side;
 }
 
-// --- makeMove / unmakeMove --------------------------------------------------
-// makeMove records previous castling-rights snapshot in the Move record
-Move board::makeMove(int fromR, int fromC, int toR, int toC, Piece promotion) {
-    Move mv;
-    mv.fromR = fromR; mv.fromC = fromC;
-    mv.toR = toR; mv.toC = toC;
-    mv.moved = CurrentState[fromR][fromC];
-    mv.captured = CurrentState[toR][toC];
-
-    // ---- UPDATE 50-MOVE RULE CLOCK ----
-    mv.prevHalfMoveClock = halfMoveClock;
-
+void board::unmakeMove(PackedMove m) {
+    const UndoInfo &u = undoStack.back();
+    const int from = m.from();
+    const int to = m.to();
+
+    switch (m.kind()) {
+    case PackedMove::EnPassant:
+        movePiece(to, from);
+        putPiece(u.captured, to + (isWhitePiece(squares[from]) ? 8 : -8));
+        break;
+    case PackedMove::Castling:
+        movePiece(to, from);
+        if (to > from) movePiece(to - 1, to + 1);
+        else movePiece(to + 1, to - 2);
+        break;
+    case PackedMove::Promotion: {
+        const Piece pawn = isWhitePiece(squares[to]) ? WP : BP;
+        removePiece(to);
+        putPiece(pawn, from);
+        if (u.captured != EMPTY) putPiece(u.captured, to);
+        break;
+    }
+    default:
+        movePiece(to, from);
+        if (u.captured != EMPTY) putPiece(u.captured, to);
+        break;
+    }
 
+    // The pieces are back; everything else is the saved state
+    castling = u.castling;
+    halfMoveClock = u.halfMoveClock;
+    enPassantTarget = u.epSquare < 0 ? std::make_pair(-1, -1) : std::make_pair(rowOf(u.epSquare), colOf(u.epSquare));
+    zobristKey = u.key;
+    undoStack.pop_back();
+}
 
+void board::makeNullMove() {
+    UndoInfo u;
+    u.key = zobristKey;
+    u.captured = EMPTY;
+    u.castling = std::uint8_t(castling);
+    u.epSquare = std::int8_t(enPassantTarget.first == -1 ? -1 : squareOf(enPassantTarget.first, enPassantTarget.second));
+    u.halfMoveClock = halfMoveClock;
+    undoStack.push_back(u);
 
-    // Save previous castling rights snapshot
-    mv.prevWhiteKingMoved = whiteKingMoved;
-    mv.prevBlackKingMoved = blackKingMoved;
-    mv.prevWhiteLeftRookMoved = whiteLeftRookMoved;
-    mv.prevWhiteRightRookMoved = whiteRightRookMoved;
-    mv.prevBlackLeftRookMoved = blackLeftRookMoved;
-    mv.prevBlackRightRookMoved = blackRightRookMoved;
+    if (enPassantTarget.first != -1) zobristKey ^= Zobrist.epFile[enPassantTarget.second];
+    enPassantTarget = {-1, -1};
+    halfMoveClock = 0;   // positions before the null move cannot recur after it
+    zobristKey ^= Zobrist.side;
+}
 
-    // Save previous en-passant target
-    mv.prevEnPassantTarget = enPassantTarget;
+void board::unmakeNullMove() {
+    const UndoInfo &u = undoStack.back();
+    halfMoveClock = u.halfMoveClock;
+    enPassantTarget = u.epSquare < 0 ? std::make_pair(-1, -1) : std::make_pair(rowOf(u.epSquare), colOf(u.epSquare));
+    zobristKey = u.key;
+    undoStack.pop_back();
+}
 
-    // clear promotion/en-passant flags by default
-    mv.wasPromotion = false;
-    mv.promotedTo = EMPTY;
-    mv.wasEnPassant = false;
+Piece board::capturedPiece(PackedMove m) const {
+    if (m.kind() == PackedMove::EnPassant)
+        return isWhitePiece(squares[m.from()]) ? BP : WP;
+    return squares[m.to()];
+}
 
-    Piece p = mv.moved;
+// --- static exchange evaluation -----------------------------------------------
+namespace {
+// exchange values, indexed by Piece; the king outweighs anything it could win
+const int SeeValue[13] = { 0, 900, 500, 100, 320, 20000, 330, 900, 500, 100, 320, 20000, 330 };
+}
 
-    if (p == WP || p == BP || mv.captured != EMPTY)
-        halfMoveClock = 0;   // pawn move or capture resets count
-    else
-        halfMoveClock += 1;  // quiet move
-
-    // ---- EN PASSANT CAPTURE DETECTION ----
-    // If a pawn moves diagonally into an empty square which equals enPassantTarget, then it's an en-passant capture.
-    if ((p == WP || p == BP) && abs(fromC - toC) == 1 && fromR != toR && CurrentState[toR][toC] == EMPTY) {
-        if (enPassantTarget.first == toR && enPassantTarget.second == toC) {
-            mv.wasEnPassant = true;
-            // Captured pawn sits behind the target square
-            int capturedPawnRow = (p == WP) ? toR + 1 : toR - 1;
-            mv.captured = CurrentState[capturedPawnRow][toC];
-            // Remove the captured pawn from its square
-            CurrentState[capturedPawnRow][toC] = EMPTY;
-        }
+// Swap-list algorithm: gain[d] is what the side making capture d wins if the
+// opponent stops afterwards. Each side takes with its least valuable attacker;
+// the list is then folded back from the end with "stop or continue".
+int board::see(PackedMove m) const {
+    const int from = m.from();
+    const int to = m.to();
+    const bool moverWhite = isWhitePiece(squares[from]);
+
+    Bitboard occ = occupiedBB ^ squareBB(from);
+    Piece onSquare = squares[from];     // piece standing on `to`, next to be taken
+    int gain[32];
+    gain[0] = SeeValue[capturedPiece(m)];
+
+    if (m.kind() == PackedMove::EnPassant) {
+        occ ^= squareBB(to + (moverWhite ? 8 : -8));
+    } else if (m.kind() == PackedMove::Promotion) {
+        onSquare = m.promotion(moverWhite);
+        gain[0] += SeeValue[onSquare] - SeeValue[WP];
     }
 
-    // ---- APPLY MOVE ----
-    CurrentState[toR][toC] = p;
-    CurrentState[fromR][fromC] = EMPTY;
-
-    // ---- CASTLING DETECTION & rook movement ----
-    // If a king moved two squares horizontally, treat it as castling and move the rook
-    if ((p == WK || p == BK) && fromR == toR && abs(toC - fromC) == 2) {
-        int row = fromR;
-        if (toC == fromC + 2) {
-            // king-side: rook moves from h-file to f-file (7 -> 5)
-            CurrentState[row][5] = CurrentState[row][7];
-            CurrentState[row][7] = EMPTY;
-        } else if (toC == fromC - 2) {
-            // queen-side: rook moves from a-file to d-file (0 -> 3)
-            CurrentState[row][3] = CurrentState[row][0];
-            CurrentState[row][0] = EMPTY;
-        }
+    const Bitboard diagonal = pieceBB[WB] | pieceBB[BB] | pieceBB[WQ] | pieceBB[BQ];
+    const Bitboard straight = pieceBB[WR] | pieceBB[BR] | pieceBB[WQ] | pieceBB[BQ];
+    Bitboard attackers = attackersTo(to, occ) & occ;
+    bool white = !moverWhite;
+    int d = 0;
+
+    while (true) {
+        const Bitboard mine = attackers & colorBB[white];
+        if (!mine) break;
+
+        // least valuable attacker
+        static const Piece order[2][6] = { { BP, BN, BB, BR, BQ, BK }, { WP, WN, WB, WR, WQ, WK } };
+        Piece attacker = EMPTY;
+        Bitboard fromBB = 0;
+        for (Piece p : order[white])
+            if ((fromBB = mine & pieceBB[p])) { attacker = p; break; }
+        fromBB &= 0 - fromBB;
+
+        // the king may only take when nothing can take back
+        if ((attacker == WK || attacker == BK) && (attackers & colorBB[!white])) break;
+
+        ++d;
+        gain[d] = SeeValue[onSquare] - gain[d - 1];
+
+        occ ^= fromBB;
+        attackers |= (bishopAttacks(to, occ) & diagonal) | (rookAttacks(to, occ) & straight);
+        attackers &= occ;
+        onSquare = attacker;
+        white = !white;
     }
 
-    // ---- PAWN PROMOTION DETECTION ----
-    // If a pawn reached the last rank, apply promotion piece (promotion parameter wins, otherwise default to queen)
-    if (p == WP && toR == 0) {
-        mv.wasPromotion = true;
-        if (promotion != EMPTY)
-            mv.promotedTo = promotion;
-        else
-            mv.promotedTo = WQ; // default queen
-        CurrentState[toR][toC] = mv.promotedTo;
-    } else if (p == BP && toR == 7) {
-        mv.wasPromotion = true;
-        if (promotion != EMPTY)
-            mv.promotedTo = promotion;
-        else
-            mv.promotedTo = BQ;
-        CurrentState[toR][toC] = mv.promotedTo;
+    while (d > 0) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        --d;
     }
+    return gain[0];
+}
 
-    // ---- UPDATE en-passant TARGET ----
-    // Reset by default; set if this move was a pawn double-step.
-    enPassantTarget = {-1, -1};
-    if (p == WP && fromR == 6 && toR == 4) {
-        // white moved 6 -> 4, en-passant target is square passed over (5, fromC)
-        enPassantTarget = {5, fromC};
-    } else if (p == BP && fromR == 1 && toR == 3) {
-        // black moved 1 -> 3, en-passant target is square passed over (2, fromC)
-        enPassantTarget = {2, fromC};
+// Square-based moves from the GUI: the kind is worked out from the position.
+// A pawn reaching the last rank promotes to `promotion`, or to a queen.
+PackedMove board::packGuiMove(int from, int to, Piece promotion) const {
+    const Piece p = squares[from];
+    const bool white = isWhitePiece(p);
+
+    if (p == WP || p == BP) {
+        if (rowOf(to) == (white ? 0 : 7))
+            return PackedMove(from, to, PackedMove::Promotion, promotion != EMPTY ? promotion : (white ? WQ : BQ));
+        if (colOf(from) != colOf(to) && squares[to] == EMPTY
+            && enPassantTarget.first == rowOf(to) && enPassantTarget.second == colOf(to))
+            return PackedMove(from, to, PackedMove::EnPassant);
     }
+    if ((p == WK || p == BK) && std::abs(to - from) == 2)
+        return PackedMove(from, to, PackedMove::Castling);
+    return PackedMove(from, to);
+}
 
-    // ---- UPDATE CASTLING RIGHTS (permanent change) ----
-    // Note: we saved previous flags in mv; unmakeMove will restore them.
-    if (p == WK) whiteKingMoved = true;
-    if (p == BK) blackKingMoved = true;
+Move board::makeMove(int fromR, int fromC, int toR, int toC, Piece promotion) {
+    const PackedMove pm = packGuiMove(squareOf(fromR, fromC), squareOf(toR, toC), promotion);
 
-    if (p == WR) {
-        if (fromR == 7 && fromC == 0) whiteLeftRookMoved = true;
-        if (fromR == 7 && fromC == 7) whiteRightRookMoved = true;
-    }
-    if (p == BR) {
-        if (fromR == 0 && fromC == 0) blackLeftRookMoved = true;
-        if (fromR == 0 && fromC == 7) blackRightRookMoved = true;
-    }
+    Move mv;
+    mv.fromR = fromR; mv.fromC = fromC;
+    mv.toR = toR; mv.toC = toC;
+    mv.moved = movedPiece(pm);
+    mv.captured = capturedPiece(pm);
+    mv.wasPromotion = pm.kind() == PackedMove::Promotion;
+    mv.promotedTo = mv.wasPromotion ? pm.promotion(isWhitePiece(mv.moved)) : EMPTY;
+    mv.wasEnPassant = pm.kind() == PackedMove::EnPassant;
 
+    makeMove(pm);
     return mv;
 }
 
 void board::unmakeMove(const Move &m) {
-    // Restore previous castling-rights snapshot first (so we can undo rook correctly)
-    whiteKingMoved = m.prevWhiteKingMoved;
-    blackKingMoved = m.prevBlackKingMoved;
-    whiteLeftRookMoved = m.prevWhiteLeftRookMoved;
-    whiteRightRookMoved = m.prevWhiteRightRookMoved;
-    blackLeftRookMoved = m.prevBlackLeftRookMoved;
-    blackRightRookMoved = m.prevBlackRightRookMoved;
-
-    halfMoveClock = m.prevHalfMoveClock;
-
-    // Restore previous en-passant target
-    enPassantTarget = m.prevEnPassantTarget;
-
-    // Detect if this was a castling move by seeing if moved piece is king and horizontal distance == 2
-    bool wasCastle = (m.moved == WK || m.moved == BK) && (m.fromR == m.toR) && (abs(m.toC - m.fromC) == 2);
-
-    // If it was a castling, restore rook original square first
-    if (wasCastle) {
-        int row = m.fromR;
-        if (m.toC == m.fromC + 2) {
-            // king-side: rook was moved from 7 -> 5; put it back
-            CurrentState[row][7] = CurrentState[row][5];
-            CurrentState[row][5] = EMPTY;
-        } else if (m.toC == m.fromC - 2) {
-            // queen-side: rook moved from 0 -> 3; put it back
-            CurrentState[row][0] = CurrentState[row][3];
-            CurrentState[row][3] = EMPTY;
-        }
-    }
+    const int from = squareOf(m.fromR, m.fromC);
+    const int to = squareOf(m.toR, m.toC);
 
-    // If this was a promotion, the destination square currently holds the promoted piece.
-    // Restore original pawn on from-square and captured piece on to-square.
-    if (m.wasPromotion) {
-        CurrentState[m.fromR][m.fromC] = m.moved;
-        CurrentState[m.toR][m.toC] = m.captured;
-        return;
-    }
+    PackedMove::Kind kind = PackedMove::Normal;
+    if (m.wasPromotion) kind = PackedMove::Promotion;
+    else if (m.wasEnPassant) kind = PackedMove::EnPassant;
+    else if ((m.moved == WK || m.moved == BK) && std::abs(to - from) == 2) kind = PackedMove::Castling;
 
-    // If this was an en-passant capture, we removed the captured pawn from its square at makeMove.
-    // Restore that captured pawn and restore moved piece and clear destination.
-    if (m.wasEnPassant) {
-        int capturedPawnRow = (m.moved == WP) ? m.toR + 1 : m.toR - 1;
-        CurrentState[capturedPawnRow][m.toC] = m.captured; // restore the captured pawn
-        CurrentState[m.fromR][m.fromC] = m.moved;
-        CurrentState[m.toR][m.toC] = EMPTY;
-        return;
-    }
+    unmakeMove(PackedMove(from, to, kind, m.promotedTo));
+}
 
-    // Normal undo
-    CurrentState[m.fromR][m.fromC] = m.moved;
-    CurrentState[m.toR][m.toC] = m.captured;
+std::uint64_t board::keyAfter(PackedMove m) const {
+    const int from = m.from();
+    const int to = m.to();
+    const Piece p = squares[from];
+
+    std::uint64_t k = zobristKey ^ Zobrist.side;
+    k ^= Zobrist.piece[p][from] ^ Zobrist.piece[squares[to]][to];
+    k ^= Zobrist.piece[m.kind() == PackedMove::Promotion ? m.promotion(isWhitePiece(p)) : p][to];
+    return k;
 }
 
+// --- attack queries ---------------------------------------------------------
+// Work backwards from the target square: a piece of type X attacks `sq` exactly
+// when an X standing on `sq` would attack it. One table lookup per piece type.
+Bitboard board::attackersTo(int sq, Bitboard occ) const {
+    return (pawnAttacks(false, sq) & pieceBB[WP])   // white pawns sit "below" sq
+         | (pawnAttacks(true, sq)  & pieceBB[BP])
+         | (knightAttacks(sq) & (pieceBB[WN] | pieceBB[BN]))
+         | (kingAttacks(sq)   & (pieceBB[WK] | pieceBB[BK]))
+         | (bishopAttacks(sq, occ) & (pieceBB[WB] | pieceBB[BB] | pieceBB[WQ] | pieceBB[BQ]))
+         | (rookAttacks(sq, occ)   & (pieceBB[WR] | pieceBB[BR] | pieceBB[WQ] | pieceBB[BQ]));
+}
+
+bool board::isSquareAttacked(int sq, bool byWhite) const {
+    const Piece pawn   = byWhite ? WP : BP;
+    const Piece knight = byWhite ? WN : BN;
+    const Piece bishop = byWhite ? WB : BB;
+    const Piece rook   = byWhite ? WR : BR;
+    const Piece queen  = byWhite ? WQ : BQ;
+    const Piece king   = byWhite ? WK : BK;
+
+    if (pawnAttacks(!byWhite, sq) & pieceBB[pawn]) return true;
+    if (knightAttacks(sq) & pieceBB[knight]) return true;
+    if (kingAttacks(sq) & pieceBB[king]) return true;
+    if (bishopAttacks(sq, occupiedBB) & (pieceBB[bishop] | pieceBB[queen])) return true;
+    if (rookAttacks(sq, occupiedBB) & (pieceBB[rook] | pieceBB[queen])) return true;
+    return false;
+}
 
 // --- isKingInCheck ---------------------------------------------------------
 // Returns true if the king of the given color is under attack.
-// Uses opponent pseudo-legal moves (getLegalMoves). getLegalMoves deliberately
-// does not attempt to call isKingInCheck or process castling, so there's no recursion here.
-bool board::isKingInCheck(bool white) {
-    // find king position
-    int kr = -1, kc = -1;
-    Piece kingPiece = white ? WK : BK;
-
-    for (int r = 0; r < 8; ++r) {
-        for (int c = 0; c < 8; ++c) {
-            if (CurrentState[r][c] == kingPiece) {
-                kr = r; kc = c;
-                break;
-            }
-        }
-        if (kr != -1) break;
-    }
+bool board::isKingInCheck(bool white) const {
+    Bitboard king = pieceBB[white ? WK : BK];
 
-    if (kr == -1) {
+    if (!king) {
         // No king found (should not happen in normal play). Treat as not in check.
         return false;
     }
 
-    // For every opponent piece, generate its pseudo-legal moves and see if any attack the king square.
-    for (int r = 0; r < 8; ++r) {
-        for (int c = 0; c < 8; ++c) {
-            Piece p = CurrentState[r][c];
-            if (p == EMPTY) continue;
+    return isSquareAttacked(lsb(king), !white);
+}
 
-            // skip same-color pieces
-            if (white && isWhitePiece(p)) continue;
-            if (!white && isBlackPiece(p)) continue;
+// --- legal move generation -------------------------------------------------
+// Pinned pieces of colour `white`: own pieces that are the only blocker between
+// their king and an enemy slider on the same line.
+Bitboard board::pinnedPieces(bool white, int ksq) const {
+    Bitboard snipers = (rookAttacks(ksq, 0) & (pieceBB[white ? BR : WR] | pieceBB[white ? BQ : WQ]))
+                     | (bishopAttacks(ksq, 0) & (pieceBB[white ? BB : WB] | pieceBB[white ? BQ : WQ]));
+    Bitboard pinned = 0;
+
+    while (snipers) {
+        Bitboard blockers = BetweenBB[ksq][popLsb(snipers)] & occupiedBB;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & colorBB[white]))
+            pinned |= blockers;
+    }
+    return pinned;
+}
 
-            // get pseudo-legal moves for this opponent piece
-            std::vector<std::pair<int,int>> targets = getLegalMoves(r, c);
+// --- getAllLegalMoves ------------------------------------------------------
+// Emits only legal moves, without make/unmake. Checkers and pinned pieces are
+// computed once per call:
+//   * double check      -> king moves only
+//   * single check      -> non-king moves must capture the checker or block the ray
+//   * pinned piece      -> may only move along the line through its king
+//   * king moves        -> destination tested with the king removed from occupancy,
+//                          so it cannot step back along a checking ray
+//   * en passant        -> both pawns leave their squares, so the king is re-tested
+//                          on the resulting occupancy (catches rank discovered checks)
+//   * castling          -> start, transit and landing squares must be unattacked
+std::vector<PackedMove> board::getAllLegalMoves(bool white) {
+    MoveList list;
+    generateLegal(list, white, GenAll);
+    return std::vector<PackedMove>(list.begin(), list.end());
+}
 
-            for (auto &t : targets) {
-                if (t.first == kr && t.second == kc) {
-                    // opponent can attack the king square
-                    return true;
-                }
-            }
-        }
-    }
+void board::legalMoves(MoveList &list, bool white) const {
+    list.clear();
+    generateLegal(list, white, GenAll);
+}
 
-    return false;
+void board::legalCaptures(MoveList &list, bool white) const {
+    list.clear();
+    generateLegal(list, white, GenCaptures);
 }
 
-// --- getAllLegalMoves ------------------------------------------------------
-// Generate all pseudo-legal moves for side `white`, filter out those that leave own king in check.
-// Also handles castling generation and checks its legality (by simulating passing squares).
-std::vector<Move> board::getAllLegalMoves(bool white) {
-    std::vector<Move> legalMoves;
-
-    // iterate all squares; if piece is of the requested color, get pseudo moves
-    for (int r = 0; r < 8; ++r) {
-        for (int c = 0; c < 8; ++c) {
-            Piece p = CurrentState[r][c];
-            if (p == EMPTY) continue;
-            if (white && !isWhitePiece(p)) continue;
-            if (!white && !isBlackPiece(p)) continue;
-
-            auto targets = getLegalMoves(r, c); // pseudo-legal destinations (does not include en-passant)
-            for (auto &t : targets) {
-                int tr = t.first, tc = t.second;
-
-                // If this is a pawn move that reaches promotion rank, expand into 4 promotion choices.
-                if (p == WP && tr == 0) {
-                    Piece promos[4] = { WQ, WR, WB, WN };
-                    for (Piece promo : promos) {
-                        Move m = makeMove(r, c, tr, tc, promo);
-                        bool kingInCheck = isKingInCheck(white);
-                        unmakeMove(m);
-                        if (!kingInCheck) legalMoves.push_back(m);
-                    }
-                } else if (p == BP && tr == 7) {
-                    Piece promos[4] = { BQ, BR, BB, BN };
-                    for (Piece promo : promos) {
-                        Move m = makeMove(r, c, tr, tc, promo);
-                        bool kingInCheck = isKingInCheck(white);
-                        unmakeMove(m);
-                        if (!kingInCheck) legalMoves.push_back(m);
-                    }
-                } else {
-                    // Normal move
-                    Move m = makeMove(r, c, tr, tc);
-                    bool kingInCheck = isKingInCheck(white);
-                    unmakeMove(m);
-                    if (!kingInCheck) {
-                        legalMoves.push_back(m);
-                    }
-                }
-            }
+void board::legalQuiets(MoveList &list, bool white) const {
+    list.clear();
+    generateLegal(list, white, GenQuiets);
+}
 
-            // --- EN PASSANT generation (special-case) ---
-            // If there is an en-passant target square, and this piece is a pawn that can capture it,
-            // include that capture as a legal candidate (it will be validated by make/unmake check).
-            if (p == WP || p == BP) {
-                if (enPassantTarget.first != -1) {
-                    int tr = enPassantTarget.first;
-                    int tc = enPassantTarget.second;
-                    // pawn capture direction
-                    int dir = isWhitePiece(p) ? -1 : 1;
-                    // en-passant capture: pawn must be on same rank as target +/- 1 depending
-                    // For white pawn capturing a black double-push, the white pawn sits on row 4 and captures to row 5 (target).
-                    // We check that the pawn can move diagonally into enPassantTarget from current square.
-                    if ( (tr == r + (isWhitePiece(p) ? -1 : 1)) && (abs(tc - c) == 1) ) {
-                        // simulate the en-passant move
-                        Move m = makeMove(r, c, tr, tc);
-                        bool kingInCheck = isKingInCheck(white);
-                        unmakeMove(m);
-                        if (!kingInCheck) {
-                            legalMoves.push_back(m);
-                        }
-                    }
-                }
-            }
-        }
+// Shared legal generator. GenCaptures builds only captures (en passant
+// included) and queen promotions, no castling; GenQuiets builds the rest and
+// never looks at en passant. Check and pin masks apply the same way in all modes.
+void board::generateLegal(MoveList &legalMoves, bool white, GenType type) const {
+
+    const Bitboard own = colorBB[white];
+    const Bitboard enemy = colorBB[!white];
+    const Bitboard kingBB = pieceBB[white ? WK : BK];
+    if (!kingBB) return;
+
+    const int ksq = lsb(kingBB);
+    const Bitboard checkers = attackersTo(ksq, occupiedBB) & enemy;
+    const Bitboard pinned = pinnedPieces(white, ksq);
+
+    // --- king moves ---
+    const Bitboard modeMask = type == GenCaptures ? enemy : type == GenQuiets ? ~occupiedBB : ~own;
+    Bitboard kingTargets = kingAttacks(ksq) & modeMask;
+    const Bitboard occNoKing = occupiedBB ^ kingBB;
+    while (kingTargets) {
+        int to = popLsb(kingTargets);
+        if (!(attackersTo(to, occNoKing) & enemy))
+            legalMoves.push_back(PackedMove(ksq, to));
     }
 
-    // -------------------------
-    // Now generate castling moves (if applicable). We perform these separately
-    // so we can carefully check "not in check", "squares passed not attacked", no pieces between, and that king/rook haven't moved.
-    // -------------------------
-    // White side castling
-    if (white) {
-        // King must be on initial square
-        if (!whiteKingMoved) {
-            // kingside: king on 7,4 and rook on 7,7 and rook not moved
-            if (!whiteRightRookMoved && CurrentState[7][4] == WK && CurrentState[7][7] == WR) {
-                if (CurrentState[7][5] == EMPTY && CurrentState[7][6] == EMPTY) {
-                    // king must not be in check now
-                    if (!isKingInCheck(true)) {
-                        // square king passes: f1 (7,5)
-                        Move m1 = makeMove(7,4,7,5);
-                        bool sq1ok = !isKingInCheck(true);
-                        unmakeMove(m1);
-
-                        // square king lands: g1 (7,6)
-                        Move m2 = makeMove(7,4,7,6);
-                        bool sq2ok = !isKingInCheck(true);
-                        unmakeMove(m2);
-
-                        if (sq1ok && sq2ok) {
-                            Move m_castle = makeMove(7,4,7,6); // will move rook too inside makeMove
-                            unmakeMove(m_castle); // restore; we only want the Move record
-                            legalMoves.push_back(m_castle);
-                        }
-                    }
-                }
+    // double check: only the king can move
+    if (checkers & (checkers - 1)) return;
+
+    // squares a non-king move may land on
+    Bitboard targetMask = ~own;
+    if (checkers)
+        targetMask = checkers | BetweenBB[ksq][lsb(checkers)];
+
+    const int promoRow = white ? 0 : 7;
+    const Bitboard promoRank = Bitboard(0xFF) << (8 * promoRow);
+
+    // --- pieces other than the king ---
+    Bitboard pieces = own & ~kingBB;
+    while (pieces) {
+        int from = popLsb(pieces);
+        Piece p = squares[from];
+        Bitboard targets = 0;
+
+        switch (p) {
+        case WP: case BP: {
+            int dir = white ? -8 : 8;
+            int startRow = white ? 6 : 1;
+            if (!(occupiedBB & squareBB(from + dir))) {
+                targets |= squareBB(from + dir);
+                if (rowOf(from) == startRow && !(occupiedBB & squareBB(from + 2 * dir)))
+                    targets |= squareBB(from + 2 * dir);
             }
+            targets |= pawnAttacks(white, from) & enemy;
+            if (type == GenCaptures) targets &= enemy | promoRank;
+            else if (type == GenQuiets) targets &= ~enemy;
+            break;
+        }
+        case WN: case BN: targets = knightAttacks(from); break;
+        case WB: case BB: targets = bishopAttacks(from, occupiedBB); break;
+        case WR: case BR: targets = rookAttacks(from, occupiedBB); break;
+        case WQ: case BQ: targets = queenAttacks(from, occupiedBB); break;
+        default: break;
+        }
 
-            // queenside: king on 7,4 and rook on 7,0 and rook not moved
-            if (!whiteLeftRookMoved && CurrentState[7][4] == WK && CurrentState[7][0] == WR) {
-                if (CurrentState[7][1] == EMPTY && CurrentState[7][2] == EMPTY && CurrentState[7][3] == EMPTY) {
-                    if (!isKingInCheck(true)) {
-                        Move m1 = makeMove(7,4,7,3);
-                        bool sq1ok = !isKingInCheck(true);
-                        unmakeMove(m1);
-
-                        Move m2 = makeMove(7,4,7,2);
-                        bool sq2ok = !isKingInCheck(true);
-                        unmakeMove(m2);
-
-                        if (sq1ok && sq2ok) {
-                            Move m_castle = makeMove(7,4,7,2);
-                            unmakeMove(m_castle);
-                            legalMoves.push_back(m_castle);
-                        }
-                    }
+        targets &= targetMask;
+        if (!(p == WP || p == BP)) targets &= modeMask;
+        if (pinned & squareBB(from))
+            targets &= LineBB[ksq][from];
+
+        const bool isPawn = (p == WP || p == BP);
+        while (targets) {
+            int to = popLsb(targets);
+
+            // If this is a pawn move that reaches promotion rank, expand into 4 promotion choices.
+            // A non-capturing queen promotion counts as a capture, its under-promotions as quiets.
+            if (isPawn && rowOf(to) == promoRow) {
+                const Piece promos[4] = { white ? WQ : BQ, white ? WR : BR, white ? WB : BB, white ? WN : BN };
+                const bool capture = enemy & squareBB(to);
+                for (int i = 0; i < 4; ++i) {
+                    if (type == GenCaptures && i > 0 && !capture) break;
+                    if (type == GenQuiets && i == 0) continue;
+                    legalMoves.push_back(PackedMove(from, to, PackedMove::Promotion, promos[i]));
                 }
+            } else {
+                legalMoves.push_back(PackedMove(from, to));
             }
         }
-    } else {
-        // Black side castling
-        if (!blackKingMoved) {
-            if (!blackRightRookMoved && CurrentState[0][4] == BK && CurrentState[0][7] == BR) {
-                if (CurrentState[0][5] == EMPTY && CurrentState[0][6] == EMPTY) {
-                    if (!isKingInCheck(false)) {
-                        Move m1 = makeMove(0,4,0,5);
-                        bool sq1ok = !isKingInCheck(false);
-                        unmakeMove(m1);
-
-                        Move m2 = makeMove(0,4,0,6);
-                        bool sq2ok = !isKingInCheck(false);
-                        unmakeMove(m2);
-
-                        if (sq1ok && sq2ok) {
-                            Move m_castle = makeMove(0,4,0,6);
-                            unmakeMove(m_castle);
-                            legalMoves.push_back(m_castle);
-                        }
-                    }
-                }
-            }
+    }
 
-            if (!blackLeftRookMoved && CurrentState[0][4] == BK && CurrentState[0][0] == BR) {
-                if (CurrentState[0][1] == EMPTY && CurrentState[0][2] == EMPTY && CurrentState[0][3] == EMPTY) {
-                    if (!isKingInCheck(false)) {
-                        Move m1 = makeMove(0,4,0,3);
-                        bool sq1ok = !isKingInCheck(false);
-                        unmakeMove(m1);
-
-                        Move m2 = makeMove(0,4,0,2);
-                        bool sq2ok = !isKingInCheck(false);
-                        unmakeMove(m2);
-
-                        if (sq1ok && sq2ok) {
-                            Move m_castle = makeMove(0,4,0,2);
-                            unmakeMove(m_castle);
-                            legalMoves.push_back(m_castle);
-                        }
-                    }
-                }
+    // --- EN PASSANT ---
+    if (type != GenQuiets && enPassantTarget.first != -1) {
+        const int epSq = squareOf(enPassantTarget.first, enPassantTarget.second);
+        const int capSq = epSq + (white ? 8 : -8);   // the pawn that just double-stepped
+
+        // only valid when the target sits behind an enemy pawn
+        if (pieceBB[white ? BP : WP] & squareBB(capSq)) {
+            Bitboard candidates = pawnAttacks(!white, epSq) & pieceBB[white ? WP : BP];
+            while (candidates) {
+                int from = popLsb(candidates);
+                Bitboard occAfter = (occupiedBB ^ squareBB(from) ^ squareBB(capSq)) | squareBB(epSq);
+                if (!(attackersTo(ksq, occAfter) & enemy & ~squareBB(capSq)))
+                    legalMoves.push_back(PackedMove(from, epSq, PackedMove::EnPassant));
             }
         }
     }
 
-    return legalMoves;
-}
-
-// -----------------------------
-// PSEUDO-LEGAL MOVES (fast)
-// -----------------------------
-// Creates Move records with .fromR/.fromC/.toR/.toC set and .promotedTo set for promotions.
-// Does NOT call makeMove/unmakeMove and does NOT test king safety. Used by engine search.
-std::vector<Move> board::getAllPseudoLegalMoves(bool white) {
-    std::vector<Move> moves;
-
-    for (int r = 0; r < 8; ++r) {
-        for (int c = 0; c < 8; ++c) {
-            Piece p = CurrentState[r][c];
-            if (p == EMPTY) continue;
-            if (white && !isWhitePiece(p)) continue;
-            if (!white && !isBlackPiece(p)) continue;
-
-            auto targets = getLegalMoves(r, c); // pseudo-legal destinations (fast)
-            for (auto &t : targets) {
-                int tr = t.first, tc = t.second;
-
-                // Pawn promotions: expand into 4 promotion choices
-                if ((p == WP && tr == 0) || (p == BP && tr == 7)) {
-                    if (p == WP) {
-                        Piece promos[4] = { WQ, WR, WB, WN };
-                        for (Piece promo : promos) {
-                            Move m;
-                            m.fromR = r; m.fromC = c;
-                            m.toR = tr; m.toC = tc;
-                            m.promotedTo = promo;
-                            // moved/captured left to makeMove (not required here)
-                            moves.push_back(m);
-                        }
-                    } else {
-                        Piece promos[4] = { BQ, BR, BB, BN };
-                        for (Piece promo : promos) {
-                            Move m;
-                            m.fromR = r; m.fromC = c;
-                            m.toR = tr; m.toC = tc;
-                            m.promotedTo = promo;
-                            moves.push_back(m);
-                        }
-                    }
-                } else {
-                    Move m;
-                    m.fromR = r; m.fromC = c;
-                    m.toR = tr; m.toC = tc;
-                    m.promotedTo = EMPTY;
-                    moves.push_back(m);
-                }
-            }
+    // -------------------------
+    // Now generate castling moves (if applicable). King and rook must be unmoved and
+    // the squares between them empty; the king may not start in, pass through or
+    // land on an attacked square.
+    // -------------------------
+    if (checkers || type == GenCaptures) return;
+
+    const int row = white ? 7 : 0;
+    const Piece rook = white ? WR : BR;
+
+    if ((castling & (white ? WhiteOO | WhiteOOO : BlackOO | BlackOOO)) && ksq == squareOf(row, 4)) {
+        // kingside: rook on the h-file, king passes f and lands on g
+        if ((castling & (white ? WhiteOO : BlackOO)) && pieceAt(row, 7) == rook
+            && pieceAt(row, 5) == EMPTY && pieceAt(row, 6) == EMPTY
+            && !isSquareAttacked(squareOf(row, 5), !white)
+            && !isSquareAttacked(squareOf(row, 6), !white))
+            legalMoves.push_back(PackedMove(ksq, squareOf(row, 6), PackedMove::Castling));
+
+        // queenside: rook on the a-file, b must be empty, king passes d and lands on c
+        if ((castling & (white ? WhiteOOO : BlackOOO)) && pieceAt(row, 0) == rook
+            && pieceAt(row, 1) == EMPTY && pieceAt(row, 2) == EMPTY && pieceAt(row, 3) == EMPTY
+            && !isSquareAttacked(squareOf(row, 3), !white)
+            && !isSquareAttacked(squareOf(row, 2), !white))
+            legalMoves.push_back(PackedMove(ksq, squareOf(row, 2), PackedMove::Castling));
+    }
+}
 
-            // En-passant pseudo move: if enPassantTarget exists and pawn can capture it,
-            // include that capture as a candidate. This mimics your getAllLegalMoves logic.
-            if ((p == WP || p == BP) && enPassantTarget.first != -1) {
-                int er = enPassantTarget.first;
-                int ec = enPassantTarget.second;
-                int dir = isWhitePiece(p) ? -1 : 1;
-                if ( (er == r + (isWhitePiece(p) ? -1 : 1)) && (abs(ec - c) == 1) ) {
-                    Move m;
-                    m.fromR = r; m.fromC = c;
-                    m.toR = er; m.toC = ec;
-                    m.promotedTo = EMPTY;
-                    moves.push_back(m);
-                }
-            }
-        }
+// --- validation of moves from elsewhere ----------------------------------------
+// A hash move or killer comes from another position (a key collision, a sibling
+// node). isPseudoLegal() accepts it when the moving piece can make that move
+// here, ignoring king safety; isLegal() then applies the generator's check, pin,
+// king-step, en-passant and castling rules to that single move.
+bool board::isPseudoLegal(PackedMove m, bool white) const {
+    if (!m) return false;
+
+    const int from = m.from();
+    const int to = m.to();
+    // only promotions carry promotion bits; anything else is not a generated encoding
+    if (m.kind() != PackedMove::Promotion && m != PackedMove(from, to, m.kind())) return false;
+    const Piece p = squares[from];
+    if (p == EMPTY || isWhitePiece(p) != white || (colorBB[white] & squareBB(to)))
+        return false;
+
+    const bool isPawn = (p == WP || p == BP);
+    const int promoRow = white ? 0 : 7;
+
+    switch (m.kind()) {
+    case PackedMove::Castling: {
+        const int row = white ? 7 : 0;
+        const Piece rook = white ? WR : BR;
+        if (p != (white ? WK : BK) || from != squareOf(row, 4)) return false;
+        if (to == squareOf(row, 6))
+            return (castling & (white ? WhiteOO : BlackOO)) && pieceAt(row, 7) == rook
+                && pieceAt(row, 5) == EMPTY && pieceAt(row, 6) == EMPTY;
+        if (to == squareOf(row, 2))
+            return (castling & (white ? WhiteOOO : BlackOOO)) && pieceAt(row, 0) == rook
+                && pieceAt(row, 1) == EMPTY && pieceAt(row, 2) == EMPTY && pieceAt(row, 3) == EMPTY;
+        return false;
+    }
+    case PackedMove::EnPassant:
+        return isPawn && enPassantTarget.first != -1
+            && to == squareOf(enPassantTarget.first, enPassantTarget.second)
+            && (pawnAttacks(white, from) & squareBB(to))
+            && (pieceBB[white ? BP : WP] & squareBB(to + (white ? 8 : -8)));
+    default:
+        break;
     }
 
-    // Castling as pseudo-legal: generate castling king moves if squares empty and rook present
-    // (We do NOT check "squares attacked" here — that's checked later after makeMove)
-    // White castling
-    if (white) {
-        if (!whiteKingMoved) {
-            // kingside
-            if (!whiteRightRookMoved && CurrentState[7][4] == WK && CurrentState[7][7] == WR) {
-                if (CurrentState[7][5] == EMPTY && CurrentState[7][6] == EMPTY) {
-                    Move m; m.fromR = 7; m.fromC = 4; m.toR = 7; m.toC = 6; m.promotedTo = EMPTY;
-                    moves.push_back(m);
-                }
-            }
-            // queenside
-            if (!whiteLeftRookMoved && CurrentState[7][4] == WK && CurrentState[7][0] == WR) {
-                if (CurrentState[7][1] == EMPTY && CurrentState[7][2] == EMPTY && CurrentState[7][3] == EMPTY) {
-                    Move m; m.fromR = 7; m.fromC = 4; m.toR = 7; m.toC = 2; m.promotedTo = EMPTY;
-                    moves.push_back(m);
-                }
-            }
-        }
-    } else {
-        // Black castling
-        if (!blackKingMoved) {
-            if (!blackRightRookMoved && CurrentState[0][4] == BK && CurrentState[0][7] == BR) {
-                if (CurrentState[0][5] == EMPTY && CurrentState[0][6] == EMPTY) {
-                    Move m; m.fromR = 0; m.fromC = 4; m.toR = 0; m.toC = 6; m.promotedTo = EMPTY;
-                    moves.push_back(m);
-                }
-            }
-            if (!blackLeftRookMoved && CurrentState[0][4] == BK && CurrentState[0][0] == BR) {
-                if (CurrentState[0][1] == EMPTY && CurrentState[0][2] == EMPTY && CurrentState[0][3] == EMPTY) {
-                    Move m; m.fromR = 0; m.fromC = 4; m.toR = 0; m.toC = 2; m.promotedTo = EMPTY;
-                    moves.push_back(m);
-                }
-            }
+    if (!isPawn) {
+        if (m.kind() != PackedMove::Normal) return false;
+        Bitboard targets = 0;
+        switch (p) {
+        case WN: case BN: targets = knightAttacks(from); break;
+        case WB: case BB: targets = bishopAttacks(from, occupiedBB); break;
+        case WR: case BR: targets = rookAttacks(from, occupiedBB); break;
+        case WQ: case BQ: targets = queenAttacks(from, occupiedBB); break;
+        default: targets = kingAttacks(from); break;
         }
+        return targets & squareBB(to);
     }
 
-    return moves;
+    // pawns: the kind must match the target rank
+    if ((m.kind() == PackedMove::Promotion) != (rowOf(to) == promoRow)) return false;
+    if (pawnAttacks(white, from) & colorBB[!white] & squareBB(to)) return true;
+
+    const int dir = white ? -8 : 8;
+    if (occupiedBB & squareBB(to)) return false;
+    if (to == from + dir) return true;
+    return to == from + 2 * dir && rowOf(from) == (white ? 6 : 1) && !(occupiedBB & squareBB(from + dir));
 }
 
+bool board::isLegal(PackedMove m, bool white) const {
+    const int from = m.from();
+    const int to = m.to();
+    const Bitboard enemy = colorBB[!white];
+    const Bitboard kingBB = pieceBB[white ? WK : BK];
+    if (!kingBB) return false;
+    const int ksq = lsb(kingBB);
+
+    if (m.kind() == PackedMove::Castling) {
+        const int step = to > from ? 1 : -1;
+        return !isSquareAttacked(from, !white) && !isSquareAttacked(from + step, !white)
+            && !isSquareAttacked(to, !white);
+    }
+
+    if (from == ksq)
+        return !(attackersTo(to, occupiedBB ^ kingBB) & enemy);
+
+    if (m.kind() == PackedMove::EnPassant) {
+        const int capSq = to + (white ? 8 : -8);
+        Bitboard occAfter = (occupiedBB ^ squareBB(from) ^ squareBB(capSq)) | squareBB(to);
+        return !(attackersTo(ksq, occAfter) & enemy & ~squareBB(capSq));
+    }
+
+    const Bitboard checkers = attackersTo(ksq, occupiedBB) & enemy;
+    if (checkers) {
+        if (checkers & (checkers - 1)) return false;
+        if (!((checkers | BetweenBB[ksq][lsb(checkers)]) & squareBB(to))) return false;
+    }
+    return !(pinnedPieces(white, ksq) & squareBB(from)) || (LineBB[ksq][from] & squareBB(to));
+}
 
 // --- checkmate / stalemate helpers ----------------------------------------
 bool board::isCheckmate(bool white) {
     if (!isKingInCheck(white)) return false;
-    auto moves = getAllLegalMoves(white);
+    MoveList moves;
+    legalMoves(moves, white);
     return moves.empty();
 }
 
 bool board::isStalemate(bool white) {
     if (isKingInCheck(white)) return false;
-    auto moves = getAllLegalMoves(white);
+    MoveList moves;
+    legalMoves(moves, white);
     return moves.empty();
 }
 
 std::vector<std::pair<int,int>> board::getFullyLegalDestinations(int fromR, int fromC, bool white) {
     std::vector<std::pair<int,int>> result;
     auto moves = getAllLegalMoves(white);
-    for (const auto &m : moves)
-        if (m.fromR == fromR && m.fromC == fromC)
-            result.push_back({m.toR, m.toC});
+    for (PackedMove m : moves)
+        if (m.from() == squareOf(fromR, fromC))
+            result.push_back({rowOf(m.to()), colOf(m.to())});
     return result;
 }
 
-std::string board::getPositionKey(bool whiteToMove)
+// --- FEN / notation helpers -------------------------------------------------
+bool board::loadFEN(const std::string &fen, bool &whiteToMove)
 {
-    std::string key;
-
-    // Board pieces
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            key += std::to_string(CurrentState[r][c]);
-            key += ',';
+    std::istringstream in(fen);
+    std::string placement, side, rights = "-", ep = "-";
+    int halfMove = 0;
+    if (!(in >> placement >> side)) return false;
+    in >> rights >> ep >> halfMove;
+
+    board next = *this;
+    next.clearPieces();
+
+    int r = 0, c = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            if (c != 8) return false;
+            ++r; c = 0;
+        } else if (ch >= '1' && ch <= '8') {
+            c += ch - '0';
+        } else {
+            static const std::string letters = "qrpnkbQRPNKB";   // same order as enum Piece
+            size_t idx = letters.find(ch);
+            if (idx == std::string::npos || r > 7 || c > 7) return false;
+            next.putPiece(Piece(idx + 1), squareOf(r, c));
+            ++c;
         }
+        if (c > 8) return false;
     }
+    if (r != 7 || c != 8) return false;
+    if (side != "w" && side != "b") return false;
+    const bool white = side == "w";
+
+    // Move generation assumes one king a side, no pawn on a back rank and no
+    // way to capture the king of the side that has just moved
+    const Bitboard backRanks = 0xFFULL | 0xFFULL << 56;
+    if ((next.pieceBB[WP] | next.pieceBB[BP]) & backRanks) return false;
+    if (popCount(next.pieceBB[WK]) != 1 || popCount(next.pieceBB[BK]) != 1) return false;
+    if (next.isKingInCheck(!white)) return false;
+
+    next.castling = 0;
+    if (rights.find('K') != std::string::npos) next.castling |= WhiteOO;
+    if (rights.find('Q') != std::string::npos) next.castling |= WhiteOOO;
+    if (rights.find('k') != std::string::npos) next.castling |= BlackOO;
+    if (rights.find('q') != std::string::npos) next.castling |= BlackOOO;
+    next.zobristKey ^= Zobrist.castling[next.castling];
+
+    // The en-passant square counts, as in makeMove, only behind a pawn that has
+    // just double-stepped and with a pawn of the side to move attacking it
+    next.enPassantTarget = {-1, -1};
+    if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] == (white ? '6' : '3')) {
+        const int epSq = squareOf('8' - ep[1], ep[0] - 'a');
+        const int pushed = epSq + (white ? 8 : -8);
+        if (next.squares[pushed] == (white ? BP : WP)
+            && (pawnAttacks(!white, epSq) & next.pieceBB[white ? WP : BP])) {
+            next.enPassantTarget = { rowOf(epSq), colOf(epSq) };
+            next.zobristKey ^= Zobrist.epFile[colOf(epSq)];
+        }
+    }
+    if (side == "b") next.zobristKey ^= Zobrist.side;
 
-    // Turn
-    key += whiteToMove ? 'w' : 'b';
+    next.halfMoveClock = halfMove;
+    next.undoStack.clear();
 
-    // Castling rights
-    key += whiteKingMoved ? '0' : '1';
-    key += whiteLeftRookMoved ? '0' : '1';
-    key += whiteRightRookMoved ? '0' : '1';
-    key += blackKingMoved ? '0' : '1';
-    key += blackLeftRookMoved ? '0' : '1';
-    key += blackRightRookMoved ? '0' : '1';
+    *this = next;
+    whiteToMove = white;
+    return true;
+}
+
+bool board::parseMove(const std::string &text, bool white, PackedMove &move) const
+{
+    MoveList moves;
+    legalMoves(moves, white);
+    for (PackedMove m : moves)
+        if (moveToString(m) == text) { move = m; return true; }
+    return false;
+}
+
+std::string board::moveToString(PackedMove m)
+{
+    std::string s;
+    s += char('a' + colOf(m.from()));
+    s += char('8' - rowOf(m.from()));
+    s += char('a' + colOf(m.to()));
+    s += char('8' - rowOf(m.to()));
+    if (m.kind() == PackedMove::Promotion) {
+        switch (m.promotion(false)) {
+        case BQ: s += 'q'; break;
+        case BR: s += 'r'; break;
+        case BB: s += 'b'; break;
+        default: s += 'n'; break;
+        }
+    }
+    return s;
+}
 
-    // En-passant square
-    key += std::to_string(enPassantTarget.first) + ",";
-    key += std::to_string(enPassantTarget.second);
+int board::castlingRights() const
+{
+    return castling;
+}
 
-    return key;
+// --- repetition ------------------------------------------------------------
+// undoStack[i].key is the key before the i-th move still on the stack, so the same
+// side was to move at size-2, size-4, ... Positions before the last capture or
+// pawn move (halfMoveClock) cannot repeat and are skipped.
+int board::repetitionCount() const
+{
+    int count = 1;
+    int n = int(undoStack.size());
+    int stop = std::max(0, n - halfMoveClock);
+    for (int i = n - 2; i >= stop; i -= 2)
+        if (undoStack[i].key == zobristKey) ++count;
+    return count;
 }
 
+bool board::isRepetition() const
+{
+    int n = int(undoStack.size());
+    int stop = std::max(0, n - halfMoveClock);
+    for (int i = n - 4; i >= stop; i -= 2)
+        if (undoStack[i].key == zobristKey) return true;
+    return false;
+}
@@ -1,94 +1,284 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <algorithm>
 #include <vector>
 #include <utility>
-#include <unordered_map>
 #include <string>
+#include <cstdint>
+#include "bitboard.h"
 
-enum Piece{
+enum Piece : std::uint8_t {
     EMPTY,
     BQ, BR, BP, BN, BK, BB,
     WQ, WR, WP, WN, WK, WB
 };
 
-// Simple move record used for make/unmake
+// Compact move used by the generators, the search, the transposition table and
+// the PV. Bits 0-5 hold the from-square, 6-11 the to-square, 12-13 the
+// promotion piece (knight, bishop, rook, queen) and 14-15 the kind. Everything
+// else (moved and captured piece, old rights) is read from the board or kept
+// in UndoInfo. The all-zero value is "no move"; no legal move encodes to it.
+class PackedMove {
+public:
+    enum Kind { Normal = 0, Promotion = 1, EnPassant = 2, Castling = 3 };
+
+    PackedMove() = default;
+    PackedMove(int from, int to, Kind kind = Normal, Piece promotion = EMPTY)
+        : bits(std::uint16_t(from | to << 6 | promotionCode(promotion) << 12 | kind << 14)) {}
+
+    static PackedMove fromRaw(std::uint16_t raw) { PackedMove m; m.bits = raw; return m; }
+    std::uint16_t raw() const { return bits; }
+
+    int from() const { return bits & 63; }
+    int to() const { return (bits >> 6) & 63; }
+    Kind kind() const { return Kind(bits >> 14); }
+
+    // promotion piece in the colour of the side moving (only for kind() == Promotion)
+    Piece promotion(bool white) const
+    {
+        static const Piece pieces[2][4] = { { BN, BB, BR, BQ }, { WN, WB, WR, WQ } };
+        return pieces[white][(bits >> 12) & 3];
+    }
+
+    explicit operator bool() const { return bits != 0; }
+    bool operator==(PackedMove other) const { return bits == other.bits; }
+    bool operator!=(PackedMove other) const { return bits != other.bits; }
+
+private:
+    static int promotionCode(Piece p)
+    {
+        switch (p) {
+        case WB: case BB: return 1;
+        case WR: case BR: return 2;
+        case WQ: case BQ: return 3;
+        default: return 0;
+        }
+    }
+
+    std::uint16_t bits = 0;
+};
+
+// Irreversible state saved by makeMove and restored by unmakeMove
+struct UndoInfo {
+    std::uint64_t key;            // Zobrist key before the move
+    Piece captured;               // captured piece (the pawn for en passant), EMPTY if none
+    std::uint8_t castling;        // castling-rights mask
+    std::int8_t epSquare;         // en-passant target square, -1 if none
+    int halfMoveClock;
+};
+
+// Full move record for the GUI (history, notation, undo/redo). The search
+// never builds these; it works on PackedMove.
 struct Move {
     int fromR, fromC;
     int toR, toC;
     Piece moved;      // piece that moved
     Piece captured;   // captured piece (if any)
 
-    // Snapshot of castling rights so unmake can restore them
-    bool prevWhiteKingMoved;
-    bool prevBlackKingMoved;
-    bool prevWhiteLeftRookMoved;
-    bool prevWhiteRightRookMoved;
-    bool prevBlackLeftRookMoved;
-    bool prevBlackRightRookMoved;
-
     // Promotion support
     bool wasPromotion = false;
     Piece promotedTo = EMPTY;
 
     bool wasEnPassant;
-    std::pair<int,int> prevEnPassantTarget;
+};
+
+// Fixed-capacity move list. It lives on the stack or inside a preallocated
+// search stack, so generating moves never touches the heap. No legal chess
+// position has more than 218 moves.
+class MoveList {
+public:
+    static const int Capacity = 256;
+
+    MoveList() {}
 
-    int prevHalfMoveClock;
+    void push_back(PackedMove m) { moves[count++] = m; }
+    void clear() { count = 0; }
+    size_t size() const { return size_t(count); }
+    bool empty() const { return count == 0; }
+
+    PackedMove &operator[](size_t i) { return moves[i]; }
+    PackedMove operator[](size_t i) const { return moves[i]; }
+    PackedMove *begin() { return moves; }
+    PackedMove *end() { return moves + count; }
+    const PackedMove *begin() const { return moves; }
+    const PackedMove *end() const { return moves + count; }
+
+private:
+    // Inside an anonymous union the entries are left uninitialised: only the
+    // first `count` are ever written and read.
+    union {
+        PackedMove moves[Capacity];
+    };
+    int count = 0;
 };
 
+// FEN of the initial position
+const char *const StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
 class board
 {
 public:
-    std::vector<std::vector<Piece>> CurrentState;
+    // Read-only 8x8 view over the square array, for UI code that still indexes
+    // the board as [row][col]. Search and evaluation use the bitboards instead.
+    struct StateView {
+        const Piece *squares;
+        const Piece *operator[](int row) const { return squares + row * 8; }
+    };
+    StateView currentState() const { return StateView{ squares }; }
+    Piece pieceAt(int r, int c) const { return squares[squareOf(r, c)]; }
+
+    // bitboard accessors
+    Bitboard pieces(Piece p) const { return pieceBB[p]; }
+    Bitboard pieces(bool white) const { return colorBB[white]; }
+    Bitboard occupied() const { return occupiedBB; }
+
     board();
     void reset_board();
     void update_board();
 
-    // pseudo-legal generator
-    std::vector<std::pair<int,int>> getLegalMoves(int row, int col);
-
-
     // returns fully legal destinations for a piece (uses getAllLegalMoves)
     std::vector<std::pair<int,int>> getFullyLegalDestinations(int fromR, int fromC, bool white);
 
-    // make / unmake a move (simple; used for testing move legality)
+    // make / unmake a move given by squares, for the GUI. The returned record
+    // describes the move for history and notation; unmakeMove takes it back.
     // NOTE: added `promotion` parameter (EMPTY unless a promotion is requested)
     Move makeMove(int fromR, int fromC, int toR, int toC, Piece promotion = EMPTY);
     void unmakeMove(const Move &m);
 
+    // make / unmake a generated move; the irreversible state goes on the undo
+    // stack, so moves must be taken back in reverse order
+    void makeMove(PackedMove m);
+    void unmakeMove(PackedMove m);
+
+    // Passes the turn (null-move pruning): only the side to move and the
+    // en-passant square change. Repetition checks do not look past it.
+    void makeNullMove();
+    void unmakeNullMove();
+
+    // any knight, bishop, rook or queen of that colour (null-move zugzwang guard)
+    bool hasNonPawnMaterial(bool white) const
+    {
+        return colorBB[white] & ~pieceBB[white ? WP : BP] & ~pieceBB[white ? WK : BK];
+    }
+
+    // what a move does on the current position (before it is made)
+    Piece movedPiece(PackedMove m) const { return squares[m.from()]; }
+    Piece capturedPiece(PackedMove m) const;
+    bool isCapture(PackedMove m) const { return squares[m.to()] != EMPTY || m.kind() == PackedMove::EnPassant; }
+
+    // Static exchange evaluation: material the side making `m` ends up with
+    // (centipawns) after the best sequence of captures on the target square,
+    // each side free to stop. Attackers hidden behind others (x-rays) join as
+    // the line opens; pins are ignored. Also meaningful for quiet moves (what
+    // the moved piece is risking on its new square).
+    int see(PackedMove m) const;
+
+    // attack queries: all pieces (both colours) attacking `square` given occupancy `occ`,
+    // and whether any piece of colour `byWhite` attacks `square`
+    Bitboard attackersTo(int square, Bitboard occ) const;
+    bool isSquareAttacked(int square, bool byWhite) const;
+
     // king-in-check test
-    bool isKingInCheck(bool white);
+    bool isKingInCheck(bool white) const;
+
+    // fully legal moves
+    std::vector<PackedMove> getAllLegalMoves(bool white);
 
-    // fully legal moves (returns Move records)
-    std::vector<Move> getAllLegalMoves(bool white);
-    std::vector<Move> getAllPseudoLegalMoves(bool white);
+    // Allocation-free generators for search and perft; all replace the list contents.
+    // legalCaptures() emits captures (en passant included) and queen promotions only;
+    // legalQuiets() emits everything else (quiet moves, castling, under-promotions
+    // without capture). Together the two produce exactly legalMoves().
+    void legalMoves(MoveList &list, bool white) const;
+    void legalCaptures(MoveList &list, bool white) const;
+    void legalQuiets(MoveList &list, bool white) const;
+
+    // Validation of moves that were not generated here (hash move, killers): the
+    // first test is cheap and rules out moves that do not fit the position at all;
+    // the second, valid only for moves passing the first, adds checks and pins.
+    bool isPseudoLegal(PackedMove m, bool white) const;
+    bool isLegal(PackedMove m, bool white) const;
+
+    // Makes room for `plies` more moves in the repetition history, so make/unmake
+    // does not reallocate during a search
+    void reserveHistory(size_t plies) { undoStack.reserve(undoStack.size() + plies); }
 
     // checkmate / stalemate
     bool isCheckmate(bool white);
     bool isStalemate(bool white);
 
+    // FEN setup: loads the position and reports the side to move.
+    // Returns false (board unchanged) if the string is malformed.
+    bool loadFEN(const std::string &fen, bool &whiteToMove);
+
+    // coordinate notation used by perft/UCI, e.g. "e2e4", "e7e8q"
+    static std::string moveToString(PackedMove m);
+
+    // The legal move of `white` written as `text` in that notation; false if none
+    bool parseMove(const std::string &text, bool white, PackedMove &move) const;
+
+    // castling availability as a bitmask of the flags below
+    enum { WhiteOO = 1, WhiteOOO = 2, BlackOO = 4, BlackOOO = 8 };
+    int castlingRights() const;
+
+    // Zobrist key of the position (pieces, side to move, castling, en-passant file),
+    // kept up to date by make/unmake
+    std::uint64_t hashKey() const { return zobristKey; }
+
+    // Material + piece-square score from white's side, tapered by game phase.
+    // Kept as running totals by the piece helpers, so this is O(1).
+    int psqtScore() const;
+    int gamePhase() const { return phase; }
+
+    // the same totals recomputed from the squares (debug cross-check)
+    void computePsqt(int &mg, int &eg, int &phaseOut) const;
+
+    // Key after `m` from the current position, cheap enough to prefetch a hash
+    // bucket before makeMove. Castling and en-passant changes are ignored, so it
+    // can differ from the real key after those moves.
+    std::uint64_t keyAfter(PackedMove m) const;
+
+    // how many times the current position has occurred since the last capture or
+    // pawn move (1 = first time); isRepetition() is the cheaper "seen before"
+    // test the search uses for draw detection
+    int repetitionCount() const;
+    bool isRepetition() const;
+
     std::pair<int,int> enPassantTarget;
     int halfMoveClock = 0;
 
-    std::unordered_map<std::string, int> positionCount;
-    std::string getPositionKey(bool whiteToMove);
 
+    static bool isWhitePiece(Piece p) { return p >= WQ; }
+    static bool isBlackPiece(Piece p) { return p != EMPTY && p < WQ; }
 
 private:
-    bool isInsideBoard(int r, int c);
-    bool isWhitePiece(Piece p);
-    bool isBlackPiece(Piece p);
+    // Position storage: one contiguous block, cheap to copy for the engine thread.
+    Piece squares[64];          // square -> piece lookup, index = row * 8 + col
+    Bitboard pieceBB[13];       // one bitboard per Piece value (EMPTY slot unused)
+    Bitboard colorBB[2];        // occupancy per colour, indexed by `white`
+    Bitboard occupiedBB;        // union of both colours
+
+    PackedMove packGuiMove(int from, int to, Piece promotion) const;
+    Bitboard pinnedPieces(bool white, int ksq) const;
+    enum GenType { GenAll, GenCaptures, GenQuiets };
+    void generateLegal(MoveList &list, bool white, GenType type) const;
+
+    void clearPieces();
+    void putPiece(Piece p, int sq);
+    void removePiece(int sq);
+    void movePiece(int from, int to);
+
 
+    // Castling rights stored here (WhiteOO | WhiteOOO | BlackOO | BlackOOO)
+    int castling;
 
+    std::uint64_t zobristKey = 0;
 
-    // Castling rights stored here
-    bool whiteKingMoved;
-    bool blackKingMoved;
-    bool whiteLeftRookMoved;   // rook at a1 (white)
-    bool whiteRightRookMoved;  // rook at h1 (white)
-    bool blackLeftRookMoved;   // rook at a8 (black)
-    bool blackRightRookMoved;  // rook at h8 (black)
+    // running material + PST totals (white minus black) and game phase
+    int psqtMg = 0;
+    int psqtEg = 0;
+    int phase = 0;
+    std::vector<UndoInfo> undoStack;   // one entry per move on the make/unmake stack
 };
 
 #endif // BOARD_H
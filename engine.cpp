@@ -1,173 +1,804 @@
 #include "engine.h"
+#include "eval.h"
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
+#include <thread>
 
-static const int INF = 1000000000;
+// Scores fit in 16 bits so they can live in the transposition table.
+// Mate is MATE - ply from the root, so shorter mates score higher.
+static const int MATE = Engine::MateScore;
+static const int INF = MATE + 1;
+static const int MATE_BOUND = MATE - 256;   // anything beyond is a mate score
 
-// ----------------------------------------------
-// MATERIAL VALUES
-// ----------------------------------------------
-int Engine::pieceValue(Piece p)
+static const int MoveOverheadMs = 30;       // GUI / process latency kept in reserve
+static const int CheckInterval = 1024;      // nodes between clock checks (power of two)
+
+// Mate scores are stored relative to the node (mate-in-N from here) and turned
+// back into distance-from-root when read, so a hit at another ply stays correct.
+static int scoreToTT(int score, int ply)
 {
-    switch (p) {
-    case WP: return 100;
-    case WN: return 300;
-    case WB: return 320;
-    case WR: return 500;
-    case WQ: return 900;
-    case WK: return 0;
+    if (score >= MATE_BOUND) return score + ply;
+    if (score <= -MATE_BOUND) return score - ply;
+    return score;
+}
 
-    case BP: return -100;
-    case BN: return -300;
-    case BB: return -320;
-    case BR: return -500;
-    case BQ: return -900;
-    case BK: return 0;
+static int scoreFromTT(int score, int ply)
+{
+    if (score >= MATE_BOUND) return score - ply;
+    if (score <= -MATE_BOUND) return score + ply;
+    return score;
+}
 
-    default: return 0;
-    }
+Engine::Engine()
+{
+    tt.resize(DefaultHashMb);
+    setOptions(SearchOptions());
+}
+
+void Engine::setOptions(const SearchOptions &options)
+{
+    opts = options;
+    for (int depth = 0; depth <= MaxPly; ++depth)
+        for (int moveNumber = 0; moveNumber < 64; ++moveNumber) {
+            double r = 0;
+            if (depth > 0 && moveNumber > 0)
+                r = opts.lmrBase + std::log(double(depth)) * std::log(double(moveNumber)) / opts.lmrDivisor;
+            reductions[depth][moveNumber] = std::uint8_t(std::max(0.0, std::min(r, double(MaxPly))));
+        }
+}
+
+void Engine::setHashSize(std::size_t mb, bool hugePages)
+{
+    tt.resize(mb, hugePages);
 }
 
 // ----------------------------------------------
-// Piece-Square Tables (SIMPLE VERSION)
+// EVALUATION (see eval.cpp)
 // ----------------------------------------------
-static const int pawnPST[8][8] = {
-    {0, 0, 0, 0, 0, 0, 0, 0},
-    {5,10,10,-20,-20,10,10, 5},
-    {5,-5,-10, 0, 0,-10,-5, 5},
-    {0, 0, 0,20,20, 0, 0, 0},
-    {5, 5,10,25,25,10, 5, 5},
-    {10,10,20,30,30,20,10,10},
-    {50,50,50,50,50,50,50,50},
-    {0, 0, 0, 0, 0, 0, 0, 0}
-};
+int Engine::evaluate(board &b)
+{
+    return evaluatePosition(b);
+}
 
-static const int knightPST[8][8] = {
-    {-50,-40,-30,-30,-30,-30,-40,-50},
-    {-40,-20, 0, 0, 0, 0,-20,-40},
-    {-30, 0,10,15,15,10, 0,-30},
-    {-30, 5,15,20,20,15, 5,-30},
-    {-30, 0,15,20,20,15, 0,-30},
-    {-30, 5,10,15,15,10, 5,-30},
-    {-40,-20, 0, 5, 5, 0,-20,-40},
-    {-50,-40,-30,-30,-30,-30,-40,-50}
-};
+// ----------------------------------------------
+// MOVE ORDERING (see movepicker.h)
+// ----------------------------------------------
+// Hash move, good captures, killers and counter-move, quiets by history, bad
+// captures. The search learns from its cutoffs through the killers, the
+// counter-moves and the history table below.
+static const int HistoryMax = 1 << 14;   // history stays within +-HistoryMax
 
-static const int bishopPST[8][8] = {
-    {-20,-10,-10,-10,-10,-10,-10,-20},
-    {-10, 5, 0, 0, 0, 0, 5,-10},
-    {-10,10,10,10,10,10,10,-10},
-    {-10, 0,10,10,10,10, 0,-10},
-    {-10, 5, 5,10,10, 5, 5,-10},
-    {-10, 0, 5,10,10, 5, 0,-10},
-    {-10, 0, 0, 0, 0, 0, 0,-10},
-    {-20,-10,-10,-10,-10,-10,-10,-20}
-};
+static bool isQuiet(const board &b, PackedMove m)
+{
+    return !b.isCapture(m) && m.kind() != PackedMove::Promotion;
+}
 
-// (Rook, Queen, King PST skipped for simplicity; 1500 Elo doesn't need them)
+// promotion piece of `m`, EMPTY if it is not a promotion (colour does not matter
+// for the value tables below)
+static Piece promotionOf(PackedMove m)
+{
+    return m.kind() == PackedMove::Promotion ? m.promotion(true) : EMPTY;
+}
 
-int Engine::pstValue(Piece p, int r, int c)
+SearchThread::SearchThread()
+    : stack(new SearchStack[MaxPly + 1])
 {
-    if (p == WP) return  pawnPST[r][c];
-    if (p == BP) return -pawnPST[7-r][c];
+    std::memset(history, 0, sizeof(history));
+    rootMoves.clear();
+}
 
-    if (p == WN) return  knightPST[r][c];
-    if (p == BN) return -knightPST[7-r][c];
+// Killers refer to the previous game position and are dropped; history is
+// halved so recent searches weigh more; counter-moves are kept as they are.
+void SearchThread::newSearch()
+{
+    nodes = 0;
+    completedDepth = 0;
+    bestScore = 0;
+    stats = SearchStats();
+    pvLength = 0;
+    for (int ply = 0; ply <= MaxPly; ++ply) {
+        stack[ply].killers[0] = stack[ply].killers[1] = PackedMove();
+        stack[ply].pvLength = 0;
+    }
+    for (auto &side : history)
+        for (auto &from : side)
+            for (int &h : from) h /= 2;
+}
 
-    if (p == WB) return  bishopPST[r][c];
-    if (p == BB) return -bishopPST[7-r][c];
+// History bonus grows with depth; the update saturates so scores stay within
+// +-HistoryMax ("history gravity").
+static void addHistory(int &entry, int bonus)
+{
+    entry += bonus - entry * std::abs(bonus) / HistoryMax;
+}
+
+// A quiet move failed high: reward it, penalise the quiet moves searched
+// before it (stack[ply].quiets), and remember it as killer and counter-move.
+void Engine::updateQuietStats(SearchThread &t, PackedMove best, int depth, int ply) const
+{
+    SearchStack &ss = t.stack[ply];
+    const bool white = t.whiteToMove == (ply % 2 == 0);
+    const int bonus = std::min(depth * depth, 400);
+
+    addHistory(t.history[white][best.from()][best.to()], bonus);
+    for (int i = 0; i < ss.quietCount; ++i)
+        addHistory(t.history[white][ss.quiets[i].from()][ss.quiets[i].to()], -bonus);
 
-    return 0;
+    if (ss.killers[0] != best) {
+        ss.killers[1] = ss.killers[0];
+        ss.killers[0] = best;
+    }
+    if (ply > 0)
+        t.counterMoves[t.stack[ply - 1].movedPiece][t.stack[ply - 1].movedTo] = best;
+}
+
+// The best line from `ply` is `move` followed by the best line one ply deeper
+static void updatePv(SearchThread &t, int ply, PackedMove move)
+{
+    SearchStack &ss = t.stack[ply];
+    const SearchStack &next = t.stack[ply + 1];
+    ss.pv[0] = move;
+    std::memcpy(ss.pv + 1, next.pv, sizeof(next.pv[0]) * next.pvLength);
+    ss.pvLength = next.pvLength + 1;
 }
 
 // ----------------------------------------------
-// EVALUATION = material + PST + mobility
+// NEGAMAX + ALPHA-BETA (principal variation search)
 // ----------------------------------------------
-int Engine::evaluate(board &b)
+// The first move of a node is searched with the full window; every later move
+// only has to prove it is no better, with a null window around alpha. If that
+// scout fails high inside the window, the move is searched again in full.
+// Nodes with a null window (beta == alpha + 1) are never on the PV and may take
+// transposition-table cutoffs; PV nodes search on so the line stays complete.
+//
+// Selectivity (see SearchOptions):
+//  * null move  - at a non-PV node whose static eval is already >= beta, let
+//                 the opponent move twice at reduced depth; if that still
+//                 fails high the node is cut. Skipped in check, after another
+//                 null move, and without pieces (pawn endings are zugzwang-prone).
+//  * LMR        - quiet moves late in the ordering that do not give check are
+//                 searched shallower first and re-searched at full depth only
+//                 if they beat alpha.
+//  * near the leaves, at non-PV nodes out of check, driven by the static eval
+//    on the search stack:
+//      reverse futility - eval - margin * depth >= beta: return eval
+//      razoring         - eval + margin * depth < alpha: return quiescence if
+//                         it confirms the fail low
+//      futility         - eval + base + margin * depth <= alpha: skip quiet
+//                         moves that do not give check
+//      late-move pruning - skip quiet moves once base + depth^2 were searched
+//      SEE              - skip quiet moves that lose more than margin * depth
+//                         of material on their target square
+int Engine::negamax(SearchThread &t, int depth, int ply, int alpha, int beta, bool whiteToMove)
 {
-    int score = 0;
+    if (depth <= 0)
+        return quiescence(t, ply, alpha, beta, whiteToMove);
+
+    board &b = t.pos;
+    SearchStack &ss = t.stack[ply];
+    ss.pvLength = 0;
+
+    // Only this thread writes its counter, so a relaxed load + store is enough
+    std::uint64_t n = t.nodes.load(std::memory_order_relaxed) + 1;
+    t.nodes.store(n, std::memory_order_relaxed);
+    if (t.id == 0 && (n & (CheckInterval - 1)) == 0) checkLimits();
+    if (stopped.load(std::memory_order_relaxed)) return 0;
+
+    if (ply >= MaxPly) {
+        int score = evaluate(b); // white's point of view
+        return whiteToMove ? score : -score;
+    }
+
+    // Draw by repetition or the fifty-move rule, ahead of the TT so a stored
+    // score of the same position reached by another path cannot hide it. One
+    // earlier occurrence is enough: if repeating is good, it can be repeated.
+    if (ply > 0 && (b.isRepetition() || b.halfMoveClock >= 100)) return 0;
+
+    const bool pvNode = beta - alpha > 1;
+    const int alphaOrig = alpha;
+    const std::uint64_t key = b.hashKey();
+
+    // --- Transposition table: cutoff on a deep enough bound, else just the move ---
+    PackedMove hashMove;
+    TTHit hit;
+    if (tt.probe(key, hit)) {
+        hashMove = hit.move;
+        if (!pvNode && hit.depth >= depth) {
+            int score = scoreFromTT(hit.score, ply);
+            if (hit.bound == BoundExact
+                || (hit.bound == BoundLower && score >= beta)
+                || (hit.bound == BoundUpper && score <= alpha))
+                return score;
+        }
+    }
 
-    // --- Material + PST ---
-    for (int r = 0; r < 8; r++) {
-        for (int c = 0; c < 8; c++) {
-            Piece p = b.CurrentState[r][c];
-            if (p == EMPTY) continue;
+    // --- Static evaluation, shared by the pruning rules below ---
+    const bool inCheck = b.isKingInCheck(whiteToMove);
+    if (inCheck) {
+        ss.staticEval = -INF;
+    } else {
+        ss.staticEval = evaluate(b);
+        if (!whiteToMove) ss.staticEval = -ss.staticEval;
+    }
+    const int eval = ss.staticEval;
+
+    if (!pvNode && !inCheck) {
+        // --- Reverse futility: far enough above beta that a quiet move will not fall back ---
+        if (depth <= opts.reverseFutilityDepth && std::abs(beta) < MATE_BOUND
+            && eval - opts.reverseFutilityMargin * depth >= beta) {
+            ++t.stats.reverseFutilityCutoffs;
+            return eval;
+        }
 
-            score += pieceValue(p);
-            score += pstValue(p, r, c);
+        // --- Razoring: hopelessly below alpha; only captures could still help ---
+        if (depth <= opts.razorDepth && eval + opts.razorMargin * depth < alpha) {
+            int score = quiescence(t, ply, alpha, alpha + 1, whiteToMove);
+            if (stopped.load(std::memory_order_relaxed)) return 0;
+            if (score <= alpha) {
+                ++t.stats.razorCutoffs;
+                return score;
+            }
+        }
+
+        // --- Null move ---
+        if (opts.nullMove && depth >= opts.nullMoveMinDepth && eval >= beta
+            && t.stack[ply - 1].movedPiece != EMPTY && b.hasNonPawnMaterial(whiteToMove)) {
+            int r = opts.nullMoveBase + depth / opts.nullMoveDepthDivisor
+                  + std::min(3, (eval - beta) / opts.nullMoveEvalDivisor);
+            ss.movedPiece = EMPTY;   // marks the null move for the child
+            ss.movedTo = 0;
+            b.makeNullMove();
+            int score = -negamax(t, depth - 1 - r, ply + 1, -beta, -beta + 1, !whiteToMove);
+            b.unmakeNullMove();
+
+            if (stopped.load(std::memory_order_relaxed)) return 0;
+            if (score >= beta) {
+                ++t.stats.nullMoveCutoffs;
+                return score >= MATE_BOUND ? beta : score;   // unproven mates are not trusted
+            }
         }
     }
 
-    // --- Mobility bonus (simple) ---
-    auto whiteMoves = b.getAllLegalMoves(true);
-    auto blackMoves = b.getAllLegalMoves(false);
+    // Futility and late-move pruning skip quiet moves at shallow non-PV nodes
+    // once one move has been searched (so a mate score is never invented)
+    const bool futile = !pvNode && !inCheck && depth <= opts.futilityDepth
+                        && eval + opts.futilityBase + opts.futilityMargin * depth <= alpha;
+    const int lateMoveLimit = !pvNode && !inCheck && depth <= opts.lateMovePruningDepth
+                              ? opts.lateMovePruningBase + depth * depth : MoveList::Capacity;
 
-    score += (whiteMoves.size() * 2);
-    score -= (blackMoves.size() * 2);
+    PackedMove counter;
+    if (ply > 0) counter = t.counterMoves[t.stack[ply - 1].movedPiece][t.stack[ply - 1].movedTo];
+    MovePicker picker(b, whiteToMove, ss.moves, hashMove, ss.killers, counter, t.history[whiteToMove]);
 
-    return score;
+    int best = -INF;
+    PackedMove bestMove;
+    ss.quietCount = 0;
+    int i = 0;   // moves picked so far, pruned ones included
+
+    for (PackedMove m; (m = picker.next()); ++i) {
+        const bool quiet = isQuiet(b, m);
+        const bool prunable = quiet && i > 0 && best > -MATE_BOUND && picker.stage() == MovePicker::Quiets;
+
+        if (prunable && ss.quietCount >= lateMoveLimit) {
+            ++t.stats.lateMovePrunes;
+            continue;
+        }
+        if (prunable && !pvNode && !inCheck && depth <= opts.seeQuietDepth
+            && b.see(m) < -opts.seeQuietMargin * depth) {
+            ++t.stats.seePrunes;
+            continue;
+        }
+
+        tt.prefetch(b.keyAfter(m));
+        ss.movedPiece = b.movedPiece(m);
+        ss.movedTo = m.to();
+        b.makeMove(m);
+        const bool givesCheck = b.isKingInCheck(!whiteToMove);
+
+        if (prunable && futile && !givesCheck) {
+            b.unmakeMove(m);
+            ++t.stats.futilityPrunes;
+            continue;
+        }
+
+        const int newDepth = depth - 1;
+        int score;
+        if (i == 0) {
+            score = -negamax(t, newDepth, ply + 1, -beta, -alpha, !whiteToMove);
+        } else {
+            int r = 0;
+            if (opts.lateMoveReductions && quiet && !inCheck && depth >= opts.lmrMinDepth
+                && i >= opts.lmrMinMoves && picker.stage() == MovePicker::Quiets && !givesCheck) {
+                r = reductions[depth][std::min(i + 1, 63)] - (pvNode ? 1 : 0);
+                r = std::max(0, std::min(r, newDepth - 1));
+            }
+
+            score = -negamax(t, newDepth - r, ply + 1, -alpha - 1, -alpha, !whiteToMove);
+            if (r > 0 && score > alpha) {
+                ++t.stats.lmrResearches;
+                score = -negamax(t, newDepth, ply + 1, -alpha - 1, -alpha, !whiteToMove);
+            }
+            if (score > alpha && score < beta)
+                score = -negamax(t, newDepth, ply + 1, -beta, -alpha, !whiteToMove);
+        }
+
+        b.unmakeMove(m);
+
+        if (stopped.load(std::memory_order_relaxed)) return 0; // partial result; never stored
+
+        if (score > best) {
+            best = score;
+            bestMove = m;
+            if (score > alpha) updatePv(t, ply, m);
+        }
+        alpha = std::max(alpha, score);
+
+        if (alpha >= beta) { // prune
+            ++t.stats.cutoffs;
+            if (i == 0) ++t.stats.firstMoveCutoffs;
+            if (quiet) updateQuietStats(t, m, depth, ply);
+            break;
+        }
+        if (quiet) ss.quiets[ss.quietCount++] = m;
+    }
+    if (picker.generatedQuiets()) ++t.stats.quietGenerations;
+
+    // nothing searched means no legal move (the first move is never pruned):
+    // checkmate or stalemate
+    if (best == -INF)
+        return inCheck ? -MATE + ply : 0;
+
+    TTBound bound = best >= beta ? BoundLower : best > alphaOrig ? BoundExact : BoundUpper;
+    tt.store(key, bound == BoundUpper ? PackedMove() : bestMove, scoreToTT(best, ply), depth, bound);
+
+    return best;
 }
 
 // ----------------------------------------------
-// NEGAMAX + ALPHA-BETA
+// QUIESCENCE
 // ----------------------------------------------
-int Engine::negamax(board &b, int depth, int alpha, int beta, bool whiteToMove)
-{
-    if (depth == 0)
-        return evaluate(b);
+// Resolves captures at the leaves so the static evaluation is never taken in
+// the middle of an exchange. The side to move may "stand pat" on the static
+// score; otherwise only captures and queen promotions are searched, minus
+// those that lose material (SEE < 0). In check every evasion is searched and
+// standing pat is not allowed.
+static const int DeltaMargin = 200;
 
-    auto moves = b.getAllLegalMoves(whiteToMove);
+// material won by a capture / promotion, for delta pruning
+static const int GainValue[13] = { 0, 900, 500, 100, 300, 0, 320, 900, 500, 100, 300, 0, 320 };
 
-    if (moves.empty()) {
-        // Checkmate or stalemate
-        if (b.isKingInCheck(whiteToMove))
-            return -INF + 1; // losing position
-        else
-            return 0; // stalemate
+int Engine::quiescence(SearchThread &t, int ply, int alpha, int beta, bool whiteToMove)
+{
+    board &b = t.pos;
+    SearchStack &ss = t.stack[ply];
+    ss.pvLength = 0;
+
+    std::uint64_t n = t.nodes.load(std::memory_order_relaxed) + 1;
+    t.nodes.store(n, std::memory_order_relaxed);
+    if (t.id == 0 && (n & (CheckInterval - 1)) == 0) checkLimits();
+    if (stopped.load(std::memory_order_relaxed)) return 0;
+
+    if (ply >= MaxPly) {
+        int score = evaluate(b);
+        return whiteToMove ? score : -score;
     }
 
+    const bool inCheck = b.isKingInCheck(whiteToMove);
+
     int best = -INF;
+    int standPat = -INF;
+
+    if (!inCheck) {
+        standPat = evaluate(b);
+        if (!whiteToMove) standPat = -standPat;
+        ss.staticEval = standPat;
+        if (standPat >= beta) return standPat;
+        if (standPat > alpha) alpha = standPat;
+        best = standPat;
+    }
+
+    MovePicker picker(b, whiteToMove, ss.moves, inCheck, t.history[whiteToMove]);
+    PackedMove m;
+    while ((m = picker.next())) {
+        if (!inCheck) {
+            // losing captures come after every winning one
+            if (picker.stage() == MovePicker::BadCaptures) {
+                ++t.stats.seePrunes;
+                break;
+            }
+
+            // Delta pruning: even winning this piece (and promoting) cannot lift alpha
+            const Piece promo = promotionOf(m);
+            int gain = GainValue[b.capturedPiece(m)] + (promo != EMPTY ? GainValue[promo] - 100 : 0);
+            if (standPat + gain + DeltaMargin <= alpha) continue;
+        }
 
-    for (auto &mv : moves) {
-        Move m = b.makeMove(mv.fromR, mv.fromC, mv.toR, mv.toC, mv.wasPromotion ? mv.promotedTo : EMPTY);
+        ss.movedPiece = b.movedPiece(m);
+        ss.movedTo = m.to();
+        b.makeMove(m);
 
-        int score = -negamax(b, depth - 1, -beta, -alpha, !whiteToMove);
+        int score = -quiescence(t, ply + 1, -beta, -alpha, !whiteToMove);
 
         b.unmakeMove(m);
 
-        best = std::max(best, score);
-        alpha = std::max(alpha, score);
+        if (stopped.load(std::memory_order_relaxed)) return 0;
 
-        if (alpha >= beta) break; // prune
+        if (score > best) {
+            best = score;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(t, ply, m);
+                if (alpha >= beta) break;
+            }
+        }
     }
 
+    // in check without an evasion: mated
+    if (inCheck && best == -INF) return -MATE + ply;
+
     return best;
 }
 
 // ----------------------------------------------
-// BEST MOVE SELECTION
+// TIME CONTROL
 // ----------------------------------------------
-Move Engine::findBestMove(board &b, bool whiteToMove, int depth)
+// movetime is used as given. With a clock the soft limit is an even share of
+// the remaining time (movestogo, or 30 moves in sudden death) plus most of the
+// increment; the hard limit lets one iteration overrun that up to 4x but never
+// beyond a third of the clock. A ponder search runs without limits until the
+// ponder hit starts its clock.
+void Engine::startClock(const SearchLimits &limits, bool whiteToMove)
 {
-    auto moves = b.getAllLegalMoves(whiteToMove);
+    clockStart = std::chrono::steady_clock::now();
+    nodeLimit = limits.nodes;
+    softLimitMs = hardLimitMs = 0;
+    pondering = limits.ponder;
 
-    Move bestMove;
-    int bestScore = -INF;
+    if (limits.infinite || limits.ponder) return;
+
+    if (limits.movetime > 0) {
+        softLimitMs = hardLimitMs = std::max(1, limits.movetime - MoveOverheadMs);
+        return;
+    }
+
+    int time = whiteToMove ? limits.wtime : limits.btime;
+    int inc = whiteToMove ? limits.winc : limits.binc;
+    if (time <= 0) return;
+
+    int movesToGo = limits.movestogo > 0 ? std::min(limits.movestogo, 50) : 30;
+    int available = std::max(1, time - MoveOverheadMs);
+
+    softLimitMs = std::min(available, available / movesToGo + inc * 3 / 4);
+    hardLimitMs = std::min(available, std::max(softLimitMs, std::min(softLimitMs * 4, available / 3 + inc)));
+    softLimitMs = std::max(1, softLimitMs);
+    hardLimitMs = std::max(1, hardLimitMs);
+}
 
-    for (auto &mv : moves) {
-        Move m = b.makeMove(mv.fromR, mv.fromC, mv.toR, mv.toC, mv.wasPromotion ? mv.promotedTo : EMPTY);
+int Engine::elapsedMs() const
+{
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - startTime).count());
+}
+
+int Engine::clockMs() const
+{
+    return int(std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - clockStart).count());
+}
 
-        int score = -negamax(b, depth - 1, -INF, INF, !whiteToMove);
+std::uint64_t Engine::totalNodes() const
+{
+    std::uint64_t sum = 0;
+    for (const auto &t : workers) sum += t->nodes.load(std::memory_order_relaxed);
+    return sum;
+}
+
+// Main thread: after a ponder hit the same limits apply as if the search had
+// started now on the position the opponent has just reached. Only the
+// deadlines move; the reported search time still counts from search(). The
+// hit is the caller's token in this search's limits, so a late hit meant for
+// an earlier search never reaches this one; a miss is simply a stop.
+void Engine::checkPonderHit()
+{
+    if (!pondering || !activeLimits.ponderHit || !activeLimits.ponderHit->load(std::memory_order_relaxed)) return;
+    SearchLimits limits = activeLimits;
+    limits.ponder = false;
+    startClock(limits, activeWhite);
+}
+
+// Runs every CheckInterval nodes from the main thread's negamax; the helpers
+// only watch `stopped`
+void Engine::checkLimits()
+{
+    checkPonderHit();
+    if ((hardLimitMs && clockMs() >= hardLimitMs) || (nodeLimit && totalNodes() >= nodeLimit)
+        || (activeLimits.stop && activeLimits.stop->load(std::memory_order_relaxed)))
+        stopped = true;
+}
+
+// ----------------------------------------------
+// ROOT SEARCH
+// ----------------------------------------------
+// Searches the root moves at `depth` within (alpha, beta), PVS as in negamax,
+// and moves the best one to the front of t.rootMoves for the next iteration.
+// A result <= alpha or >= beta is only a bound (the aspiration window failed)
+// and the caller searches again; after a fail high the refuting move is
+// already in front. Nothing is meaningful if the search was stopped.
+int Engine::searchRoot(SearchThread &t, int depth, int alpha, int beta, PackedMove &best)
+{
+    board &b = t.pos;
+    MoveList &moves = t.rootMoves;
+    SearchStack &ss = t.stack[0];
+    const int alphaOrig = alpha;
+    int bestScore = -INF;
+    size_t bestIndex = 0;
+    ss.pvLength = 0;
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const PackedMove m = moves[i];
+        tt.prefetch(b.keyAfter(m));
+        ss.movedPiece = b.movedPiece(m);
+        ss.movedTo = m.to();
+        b.makeMove(m);
+
+        int score;
+        if (i == 0) {
+            score = -negamax(t, depth - 1, 1, -beta, -alpha, !t.whiteToMove);
+        } else {
+            score = -negamax(t, depth - 1, 1, -alpha - 1, -alpha, !t.whiteToMove);
+            if (score > alpha && score < beta)
+                score = -negamax(t, depth - 1, 1, -beta, -alpha, !t.whiteToMove);
+        }
 
         b.unmakeMove(m);
 
+        if (stopped) break;
+
         if (score > bestScore) {
             bestScore = score;
-            bestMove = mv;
+            bestIndex = i;
+            if (score > alpha) {
+                alpha = score;
+                updatePv(t, 0, m);
+                if (alpha >= beta) break;
+            }
         }
     }
 
+    if (stopped) return 0;
+
+    // after a fail low every score is an upper bound: keep the old order
+    if (bestScore > alphaOrig)
+        std::rotate(moves.begin(), moves.begin() + bestIndex, moves.begin() + bestIndex + 1);
+    best = moves[0];
 
+    TTBound bound = bestScore >= beta ? BoundLower : bestScore > alphaOrig ? BoundExact : BoundUpper;
+    tt.store(b.hashKey(), bound == BoundUpper ? PackedMove() : best, scoreToTT(bestScore, 0), depth, bound);
+    return bestScore;
+}
 
-    return bestMove;
+// ----------------------------------------------
+// ITERATIVE DEEPENING
+// ----------------------------------------------
+// Helper threads skip some depths so they run ahead of the main thread and fill
+// the table with results it has not reached yet (skip pattern from Stockfish).
+static const int SkipSize[]  = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int SkipPhase[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+// From AspirationDepth on, each iteration starts with a window of
+// +-AspirationWindow around the previous score. A fail widens the failing side
+// by the current delta, which grows by half each time; mate scores and
+// shallow depths use the full window.
+static const int AspirationDepth = 5;
+static const int AspirationWindow = 25;
+
+void Engine::iterate(SearchThread &t, const SearchLimits &limits, int maxDepth)
+{
+    for (int depth = 1; depth <= maxDepth && !stopped; ++depth) {
+        if (t.id > 0) {
+            int i = (t.id - 1) % 20;
+            if (((depth + SkipPhase[i]) / SkipSize[i]) % 2) continue;
+        }
+
+        int alpha = -INF, beta = INF, delta = AspirationWindow;
+        if (depth >= AspirationDepth && std::abs(t.bestScore) < MATE_BOUND) {
+            alpha = std::max(t.bestScore - delta, -INF);
+            beta = std::min(t.bestScore + delta, INF);
+        }
+
+        PackedMove iterationBest;
+        int score;
+        while (true) {
+            score = searchRoot(t, depth, alpha, beta, iterationBest);
+            if (stopped) break;
+
+            if (score <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -INF);
+            } else if (score >= beta) {
+                beta = std::min(score + delta, INF);
+            } else {
+                break;
+            }
+            delta += delta / 2;
+        }
+        if (stopped) break;
+
+        t.bestMove = iterationBest;
+        t.bestScore = score;
+        t.completedDepth = depth;
+        t.pvLength = t.stack[0].pvLength;
+        std::memcpy(t.pv, t.stack[0].pv, sizeof(t.pv[0]) * t.pvLength);
+
+        if (t.id > 0) continue;
+
+        // --- main thread: report and decide whether to go deeper ---
+        checkPonderHit();
+        if (onInfo) {
+            SearchInfo info;
+            info.depth = depth;
+            info.score = score;
+            info.nodes = totalNodes();
+            info.timeMs = elapsedMs();
+            info.hashfull = tt.hashfull();
+            info.bestMove = iterationBest;
+            for (int i = 0; i < t.pvLength; ++i)
+                info.pv += (i ? " " : "") + board::moveToString(t.pv[i]);
+            info.stats = t.stats;
+            info.stats.nodes = t.nodes.load(std::memory_order_relaxed);
+            onInfo(info);
+        }
+
+        // A single legal move needs no deeper search
+        if (t.rootMoves.size() == 1 && !limits.infinite && (softLimitMs || hardLimitMs)) break;
+
+        // A mate found within the searched depth will not get any shorter
+        // (a ponder search keeps going: it may not answer before the ponder hit)
+        if (!limits.infinite && !pondering && std::abs(score) >= MATE_BOUND && MATE - std::abs(score) <= depth) break;
+
+        // Soft limit: the next iteration would most likely not finish in time
+        if (softLimitMs && clockMs() >= softLimitMs) break;
+    }
+}
+
+// Each thread votes for its best move, weighted by depth and by how far its
+// score is above the worst thread's. A proven mate wins outright (the shortest
+// one if several threads found one).
+const SearchThread &Engine::pickBestThread() const
+{
+    const SearchThread *best = workers[0].get();
+    if (workers.size() == 1) return *best;
+
+    int minScore = INF;
+    for (const auto &t : workers)
+        if (t->completedDepth > 0) minScore = std::min(minScore, t->bestScore);
+
+    auto votes = [&](const SearchThread &who) {
+        long long v = 0;
+        for (const auto &t : workers)
+            if (t->completedDepth > 0 && t->bestMove == who.bestMove)
+                v += (long long)(t->bestScore - minScore + 14) * t->completedDepth;
+        return v;
+    };
+
+    for (const auto &t : workers) {
+        if (t->completedDepth == 0 || t.get() == best) continue;
+        if (best->completedDepth == 0) { best = t.get(); continue; }
+
+        if (std::abs(best->bestScore) >= MATE_BOUND) {
+            if (t->bestScore > best->bestScore) best = t.get();
+        } else if (t->bestScore >= MATE_BOUND) {
+            best = t.get();
+        } else {
+            long long tv = votes(*t), bv = votes(*best);
+            if (tv > bv || (tv == bv && t->completedDepth > best->completedDepth)) best = t.get();
+        }
+    }
+    return *best;
+}
+
+// Lazy SMP: all threads run the same iterative deepening on their own board
+// copy. The main thread owns the clock; when it stops, the helpers are stopped
+// too and the result is picked from all of them.
+PackedMove Engine::search(board &b, bool whiteToMove, const SearchLimits &limits)
+{
+    MoveList moves;
+    b.legalMoves(moves, whiteToMove);
+    expectedReply = PackedMove();
+    if (moves.empty()) return PackedMove();
+
+    // Threads are kept between searches so their history tables carry over
+    if (int(workers.size()) != threadCount) {
+        workers.clear();
+        for (int i = 0; i < threadCount; ++i) {
+            workers.emplace_back(new SearchThread);
+            workers.back()->id = i;
+        }
+    }
+
+    // Root moves start in the usual order (hash move, captures, ...); later
+    // iterations keep the previous best first
+    TTHit hit;
+    PackedMove hashMove = tt.probe(b.hashKey(), hit) ? hit.move : PackedMove();
+    for (auto &t : workers) t->newSearch();
+    SearchThread &lead = *workers[0];
+    MovePicker picker(b, whiteToMove, lead.stack[0].moves, hashMove, lead.stack[0].killers, PackedMove(),
+                      lead.history[whiteToMove]);
+    moves.clear();
+    for (PackedMove m; (m = picker.next());) moves.push_back(m);
+
+    for (auto &t : workers) {
+        t->pos = b;
+        t->pos.reserveHistory(MaxPly + 1); // makeMove below the root must not grow the undo stack
+        t->whiteToMove = whiteToMove;
+        t->rootMoves = moves;
+        t->bestMove = moves[0]; // fallback if even the first iteration is cut short
+    }
+
+    stopped = false;
+    activeLimits = limits;
+    activeWhite = whiteToMove;
+    startTime = std::chrono::steady_clock::now();
+    startClock(limits, whiteToMove);
+    tt.newSearch();
+
+    const int maxDepth = limits.depth > 0 ? std::min(limits.depth, int(MaxDepth)) : int(MaxDepth);
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < threadCount; ++i)
+        helpers.emplace_back([this, i, &limits, maxDepth]() { iterate(*workers[i], limits, maxDepth); });
+
+    iterate(*workers[0], limits, maxDepth);
+
+    stopped = true;
+    for (auto &th : helpers) th.join();
+
+    const SearchThread &best = pickBestThread();
+    expectedReply = best.pvLength > 1 && best.pv[0] == best.bestMove ? best.pv[1] : PackedMove();
+    if (!expectedReply) {
+        // short PV (cut by the hash table): the stored move after the best one
+        b.makeMove(best.bestMove);
+        if (tt.probe(b.hashKey(), hit) && b.isPseudoLegal(hit.move, !whiteToMove) && b.isLegal(hit.move, !whiteToMove))
+            expectedReply = hit.move;
+        b.unmakeMove(best.bestMove);
+    }
+    return best.bestMove;
+}
+
+SearchStats Engine::lastStats() const
+{
+    SearchStats total;
+    for (const auto &t : workers) {
+        total.nodes += t->nodes.load(std::memory_order_relaxed);
+        total.cutoffs += t->stats.cutoffs;
+        total.firstMoveCutoffs += t->stats.firstMoveCutoffs;
+        total.nullMoveCutoffs += t->stats.nullMoveCutoffs;
+        total.lmrResearches += t->stats.lmrResearches;
+        total.reverseFutilityCutoffs += t->stats.reverseFutilityCutoffs;
+        total.razorCutoffs += t->stats.razorCutoffs;
+        total.futilityPrunes += t->stats.futilityPrunes;
+        total.lateMovePrunes += t->stats.lateMovePrunes;
+        total.seePrunes += t->stats.seePrunes;
+        total.quietGenerations += t->stats.quietGenerations;
+    }
+    return total;
+}
+
+PackedMove Engine::findBestMove(board &b, bool whiteToMove, int depth)
+{
+    SearchLimits limits;
+    limits.depth = depth;
+    return search(b, whiteToMove, limits);
+}
+
+// ----------------------------------------------
+// RUNTIME INFO
+// ----------------------------------------------
+std::string Engine::info()
+{
+    initAttackTables(); // kernel is chosen here on first use
+    return std::string("attack kernel: ") + cpuKernelName(ActiveKernel);
 }
@@ -2,18 +2,221 @@
 #define ENGINE_H
 
 #include "board.h"
+#include "movepicker.h"
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <vector>
+#include <string>
+
+// What a search may spend. Zero means "no limit" for every field; with no
+// limit at all the search runs to the maximum depth.
+struct SearchLimits {
+    int depth = 0;                // plies
+    int movetime = 0;             // ms for this move
+    int wtime = 0, btime = 0;     // remaining clock time, ms
+    int winc = 0, binc = 0;       // increment per move, ms
+    int movestogo = 0;            // moves to the next time control (0 = sudden death)
+    std::uint64_t nodes = 0;
+    bool infinite = false;        // ignore the clock; stop only on depth/nodes
+    bool ponder = false;          // searching the expected reply on the opponent's time: no
+                                  // clock until the ponder hit, then the limits above
+    const std::atomic<bool> *ponderHit = nullptr;   // caller's ponder-hit token: set once the
+                                                    // opponent plays the expected move
+    const std::atomic<bool> *stop = nullptr;   // caller's stop token: once set, the search
+                                               // ends with its best move so far
+};
+
+// Selectivity switches and parameters, so their effect on node counts and
+// solve rates can be measured. Change them only between searches.
+struct SearchOptions {
+    // null-move pruning: reduction = base + depth / depthDivisor
+    //                                + min(3, (eval - beta) / evalDivisor)
+    bool nullMove = true;
+    int nullMoveMinDepth = 3;
+    int nullMoveBase = 3;
+    int nullMoveDepthDivisor = 4;
+    int nullMoveEvalDivisor = 200;
+
+    // late-move reductions for quiet moves after the first lmrMinMoves:
+    // reduction = lmrBase + ln(depth) * ln(move number) / lmrDivisor
+    bool lateMoveReductions = true;
+    int lmrMinDepth = 3;
+    int lmrMinMoves = 3;
+    double lmrBase = 0.75;
+    double lmrDivisor = 2.25;
+
+    // Shallow-depth pruning at non-PV nodes (margins in centipawns). Each rule
+    // applies up to its depth; a depth of 0 switches it off.
+    int reverseFutilityDepth = 6;   // eval - margin * depth >= beta: cut
+    int reverseFutilityMargin = 80;
+    int razorDepth = 2;             // eval + margin * depth < alpha: verify with quiescence
+    int razorMargin = 300;
+    int futilityDepth = 3;          // eval + base + margin * depth <= alpha: skip quiets
+    int futilityBase = 100;
+    int futilityMargin = 100;
+    int lateMovePruningDepth = 3;   // skip quiets after base + depth^2 of them
+    int lateMovePruningBase = 3;
+    int seeQuietDepth = 3;          // skip quiets with SEE < -margin * depth
+    int seeQuietMargin = 60;
+};
+
+// Counters collected while searching; summed over all threads
+struct SearchStats {
+    std::uint64_t nodes = 0;
+    std::uint64_t cutoffs = 0;            // nodes that failed high
+    std::uint64_t firstMoveCutoffs = 0;   // ... on the first move searched
+    std::uint64_t nullMoveCutoffs = 0;    // nodes pruned by a null-move search
+    std::uint64_t lmrResearches = 0;      // reduced moves that had to be searched again
+    std::uint64_t reverseFutilityCutoffs = 0;
+    std::uint64_t razorCutoffs = 0;
+    std::uint64_t futilityPrunes = 0;     // moves skipped
+    std::uint64_t lateMovePrunes = 0;     // moves skipped
+    std::uint64_t seePrunes = 0;          // losing quiets in search and captures in quiescence skipped
+    std::uint64_t quietGenerations = 0;   // nodes that got as far as generating their quiet moves
+
+    // share of fail-highs caused by the first move; the closer to 1, the better the ordering
+    double firstMoveCutoffRate() const { return cutoffs ? double(firstMoveCutoffs) / cutoffs : 0.0; }
+};
+
+// Progress report sent after every completed iteration
+struct SearchInfo {
+    int depth = 0;
+    int score = 0;                // centipawns from the side to move; mates beyond +-MateScore/2
+    std::uint64_t nodes = 0;
+    int timeMs = 0;
+    int hashfull = 0;             // per mille of the table filled by this search
+    PackedMove bestMove;
+    std::string pv;               // principal variation in coordinate notation
+    SearchStats stats;            // main thread only
+};
+
+const int MaxPly = 64;            // deepest ply any search line can reach
+
+// Per-ply scratch space of one search thread. The whole stack is allocated
+// with the thread, so the search itself never allocates.
+struct SearchStack {
+    MoveBuffers moves;                         // move picker scratch for this ply
+    PackedMove quiets[MoveList::Capacity];     // quiet moves searched so far (history malus)
+    int quietCount;
+
+    PackedMove killers[2];                     // quiet moves that failed high at this ply
+    int staticEval;                            // side-to-move evaluation, when computed
+    Piece movedPiece;                          // move being searched from this ply,
+    int movedTo;                               // for counter-move lookups one ply deeper
+
+    PackedMove pv[MaxPly + 1];                 // best line from this ply
+    int pvLength;
+};
+
+// State owned by one search thread. Every thread searches its own board copy;
+// the transposition table is the only thing they share.
+struct SearchThread {
+    int id = 0;                   // 0 = main thread (clock, info, final say)
+    board pos;
+    bool whiteToMove = true;
+    MoveList rootMoves;           // best move of the last iteration first
+
+    std::atomic<std::uint64_t> nodes{0};
+    int completedDepth = 0;
+    int bestScore = 0;
+    PackedMove bestMove;
+    SearchStats stats;
+
+    PackedMove pv[MaxPly + 1];    // principal variation of the last completed iteration
+    int pvLength = 0;
+
+    // --- move ordering; kept between searches (history decays at each start) ---
+    PackedMove counterMoves[13][64];          // reply to [previous piece][previous to-square]
+    int history[2][64][64];                   // butterfly table [white][from][to]
+
+    std::unique_ptr<SearchStack[]> stack;     // MaxPly + 1 entries, indexed by ply
+
+    SearchThread();
+    void newSearch();
+};
 
 class Engine {
 public:
-    Move findBestMove(board &b, bool whiteToMove, int depth);
+    Engine();
+
+    static const int MaxDepth = MaxPly;
+    static const int MateScore = 32000;
+    static const int DefaultHashMb = 16;
+
+    // Iterative deepening within `limits`. Returns the best move of the last
+    // completed iteration, or no move if the side to move has none.
+    PackedMove search(board &b, bool whiteToMove, const SearchLimits &limits);
+
+    // fixed-depth search (same as search() with only limits.depth set)
+    PackedMove findBestMove(board &b, bool whiteToMove, int depth);
+
+    // The reply the last search expects (second move of its PV, or the hash
+    // move after its best move), to ponder on; no move if it has none
+    PackedMove ponderMove() const { return expectedReply; }
+
+    // called from the searching thread after each completed iteration
+    void setInfoCallback(std::function<void(const SearchInfo &)> callback) { onInfo = std::move(callback); }
+
+    // transposition table size; cleared on resize
+    void setHashSize(std::size_t mb, bool hugePages = false);
+    void clearHash() { tt.clear(); }
+
+    void setOptions(const SearchOptions &options);
+    const SearchOptions &options() const { return opts; }
+
+    // number of search threads (Lazy SMP); 1 = single-threaded
+    void setThreads(int count) { threadCount = std::max(1, count); }
+    int threads() const { return threadCount; }
+
+    // nodes searched by all threads in the last search()
+    std::uint64_t lastNodes() const { return totalNodes(); }
+    SearchStats lastStats() const;
+
+    // one-line description of the runtime configuration (selected CPU kernel)
+    static std::string info();
 
 private:
     int evaluate(board &b);
-    int negamax(board &b, int depth, int alpha, int beta, bool whiteToMove);
+    int negamax(SearchThread &t, int depth, int ply, int alpha, int beta, bool whiteToMove);
+    int quiescence(SearchThread &t, int ply, int alpha, int beta, bool whiteToMove);
+    int searchRoot(SearchThread &t, int depth, int alpha, int beta, PackedMove &best);
+    void updateQuietStats(SearchThread &t, PackedMove best, int depth, int ply) const;
+    void iterate(SearchThread &t, const SearchLimits &limits, int maxDepth);
+    const SearchThread &pickBestThread() const;
+
+    void startClock(const SearchLimits &limits, bool whiteToMove);
+    void checkPonderHit();
+    void checkLimits();
+    int elapsedMs() const;        // since search() started, for SearchInfo
+    int clockMs() const;          // since the clock started, for the limits
+    std::uint64_t totalNodes() const;
+
+    TranspositionTable tt;
+
+    SearchOptions opts;
+    std::uint8_t reductions[MaxPly + 1][64];   // LMR plies by [depth][move number], from opts
+
+    // --- per-search state ---
+    std::chrono::steady_clock::time_point startTime;    // search() entry
+    std::chrono::steady_clock::time_point clockStart;   // deadline base; moved by a ponder hit
+    int softLimitMs = 0;          // don't start another iteration after this
+    int hardLimitMs = 0;          // abort the running iteration after this
+    std::uint64_t nodeLimit = 0;
+    std::atomic<bool> stopped{false};
+    bool pondering = false;       // main thread only: the clock waits for the ponder hit
+    SearchLimits activeLimits;    // of the running search, for the clock after a ponder hit
+    bool activeWhite = true;
+    PackedMove expectedReply;
+
+    int threadCount = 1;
+    std::vector<std::unique_ptr<SearchThread>> workers;
 
-    int pieceValue(Piece p);
-    int pstValue(Piece p, int r, int c);
+    std::function<void(const SearchInfo &)> onInfo;
 };
 
 #endif
@@ -0,0 +1,145 @@
+#include "eval.h"
+#include "psqt.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// ----------------------------------------------
+// Weights (centipawns)
+// ----------------------------------------------
+// per reachable square in the mobility area, indexed by Piece (pawns and kings: none)
+const int MobilityWeight[13] = { 0, 1, 2, 0, 4, 0, 3, 1, 2, 0, 4, 0, 3 };
+
+// king-zone attack units per attacking piece, indexed by Piece
+const int KingAttackWeight[13] = { 0, 5, 3, 0, 2, 0, 2, 5, 3, 0, 2, 0, 2 };
+const int KingDangerMax = 500;
+
+// undefended piece under attack, indexed by Piece (the king is never "hanging")
+const int HangingPenalty[13] = { 0, 60, 45, 10, 30, 0, 30, 60, 45, 10, 30, 0, 30 };
+
+// Attack information for one side, gathered in a single pass
+struct SideAttacks {
+    Bitboard all = 0;         // every square attacked by this side
+    Bitboard pawns = 0;       // squares attacked by its pawns
+    int mobility = 0;
+    int kingUnits = 0;        // attack units on the enemy king zone
+    int kingAttackers = 0;    // pieces taking part in that attack
+};
+
+Bitboard pawnAttackSet(Bitboard pawns, bool white)
+{
+    Bitboard set = 0;
+    while (pawns) set |= pawnAttacks(white, popLsb(pawns));
+    return set;
+}
+
+Bitboard pieceAttacks(Piece p, int sq, Bitboard occ)
+{
+    switch (p) {
+    case WN: case BN: return knightAttacks(sq);
+    case WB: case BB: return bishopAttacks(sq, occ);
+    case WR: case BR: return rookAttacks(sq, occ);
+    case WQ: case BQ: return queenAttacks(sq, occ);
+    case WK: case BK: return kingAttacks(sq);
+    default: return 0;
+    }
+}
+
+// Mobility and king-zone pressure for `white`. The mobility area excludes
+// squares holding own pieces and squares the enemy pawns control.
+void collectAttacks(const board &b, bool white, Bitboard enemyPawnAttacks, Bitboard enemyKingZone, SideAttacks &out)
+{
+    const Bitboard occ = b.occupied();
+    const Bitboard area = ~b.pieces(white) & ~enemyPawnAttacks;
+
+    out.pawns = pawnAttackSet(b.pieces(white ? WP : BP), white);
+    out.all = out.pawns;
+
+    Bitboard pieces = b.pieces(white) & ~b.pieces(white ? WP : BP);
+    while (pieces) {
+        int sq = popLsb(pieces);
+        Piece p = b.pieceAt(rowOf(sq), colOf(sq));
+        Bitboard attacks = pieceAttacks(p, sq, occ);
+        out.all |= attacks;
+
+        out.mobility += MobilityWeight[p] * popCount(attacks & area);
+        if (attacks & enemyKingZone) {
+            out.kingUnits += KingAttackWeight[p] * popCount(attacks & enemyKingZone);
+            ++out.kingAttackers;
+        }
+    }
+}
+
+// Quadratic in the attack units once at least two pieces join the attack
+int kingDanger(const SideAttacks &attacker)
+{
+    if (attacker.kingAttackers < 2) return 0;
+    int danger = attacker.kingUnits * attacker.kingUnits / 4;
+    return danger < KingDangerMax ? danger : KingDangerMax;
+}
+
+int hangingPenalty(const board &b, bool white, Bitboard ownAttacks, Bitboard enemyAttacks)
+{
+    int penalty = 0;
+    Bitboard hanging = b.pieces(white) & enemyAttacks & ~ownAttacks;
+    while (hanging) {
+        int sq = popLsb(hanging);
+        penalty += HangingPenalty[b.pieceAt(rowOf(sq), colOf(sq))];
+    }
+    return penalty;
+}
+
+Bitboard kingZone(const board &b, bool white)
+{
+    Bitboard king = b.pieces(white ? WK : BK);
+    if (!king) return 0;
+    int ksq = lsb(king);
+    return kingAttacks(ksq) | squareBB(ksq);
+}
+
+} // namespace
+
+int evaluatePosition(const board &b, EvalBreakdown *terms)
+{
+    EvalBreakdown e;
+    e.material = b.psqtScore();
+
+#ifdef CHESS_DEBUG_EVAL
+    int mg, eg, phase;
+    b.computePsqt(mg, eg, phase);
+    if (taperedScore(mg, eg, phase) != e.material || phase != b.gamePhase()) {
+        std::fprintf(stderr, "evaluate: incremental psqt %d (phase %d) != recomputed %d (phase %d)\n",
+                     e.material, b.gamePhase(), taperedScore(mg, eg, phase), phase);
+        std::abort();
+    }
+#endif
+
+    // pawn attacks first: they bound the other side's mobility area
+    SideAttacks white, black;
+    const Bitboard whitePawnAttacks = pawnAttackSet(b.pieces(WP), true);
+    const Bitboard blackPawnAttacks = pawnAttackSet(b.pieces(BP), false);
+    collectAttacks(b, true, blackPawnAttacks, kingZone(b, false), white);
+    collectAttacks(b, false, whitePawnAttacks, kingZone(b, true), black);
+
+    e.mobility = white.mobility - black.mobility;
+    e.kingSafety = kingDanger(white) - kingDanger(black);
+    e.hanging = hangingPenalty(b, false, black.all, white.all) - hangingPenalty(b, true, white.all, black.all);
+    e.total = e.material + e.mobility + e.kingSafety + e.hanging;
+
+    if (terms) *terms = e;
+    return e.total;
+}
+
+std::string formatEval(const EvalBreakdown &terms)
+{
+    char text[256];
+    std::snprintf(text, sizeof(text),
+                  "  material+psqt %6d\n"
+                  "  mobility      %6d\n"
+                  "  king safety   %6d\n"
+                  "  hanging       %6d\n"
+                  "  total         %6d (white's view)\n",
+                  terms.material, terms.mobility, terms.kingSafety, terms.hanging, terms.total);
+    return text;
+}
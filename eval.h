@@ -0,0 +1,25 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "board.h"
+#include <string>
+
+// Evaluation split into its terms, every value from white's side in
+// centipawns. `total` is their sum and what the search sees.
+struct EvalBreakdown {
+    int material = 0;     // tapered material + piece-square tables (incremental, see psqt.h)
+    int mobility = 0;     // attacked squares in each side's mobility area
+    int kingSafety = 0;   // pressure on the squares around each king
+    int hanging = 0;      // pieces attacked and not defended
+    int total = 0;
+};
+
+// Static evaluation from white's point of view. Mobility, king-zone and
+// hanging terms come from one pass over per-piece attack sets (pseudo attacks,
+// no legality checks, no allocation). Pass `terms` to get the breakdown.
+int evaluatePosition(const board &b, EvalBreakdown *terms = nullptr);
+
+// multi-line table of the terms, for debugging
+std::string formatEval(const EvalBreakdown &terms);
+
+#endif // EVAL_H
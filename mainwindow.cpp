@@ -11,6 +11,11 @@
 #include <QPainter>
 #include <QPen>
 #include <QTimer>
+#include <QStatusBar>
+#include <QThread>
+#include <QFileDialog>
+#include <QMenu>
+#include <algorithm>
 
 
 MainWindow::MainWindow(QWidget *parent)
@@ -54,6 +59,19 @@ MainWindow::MainWindow(QWidget *parent)
     // Put the buttons at the top-left of the left panel (keep them left aligned)
     leftPanel->addLayout(buttonLayout);
 
+    // Engine controls: abandon the search, or play its best move so far
+    QHBoxLayout *engineButtonLayout = new QHBoxLayout();
+    QPushButton *stopBtn = new QPushButton("Stop", this);
+    QPushButton *moveNowBtn = new QPushButton("Move Now", this);
+    stopBtn->setFixedSize(50, 30);
+    moveNowBtn->setFixedSize(70, 30);
+    stopBtn->setStyleSheet("font-weight: bold; font-size: 12px;");
+    moveNowBtn->setStyleSheet("font-weight: bold; font-size: 12px;");
+
+    engineButtonLayout->addWidget(stopBtn);
+    engineButtonLayout->addWidget(moveNowBtn);
+    leftPanel->addLayout(engineButtonLayout);
+
     // Move history label (left aligned inside left panel)
     QLabel *historyLabel = new QLabel("Move History", this);
     historyLabel->setStyleSheet("font-weight: bold; font-size: 14px;");
@@ -81,6 +99,8 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(undoBtn, &QPushButton::clicked, this, &MainWindow::undoMove);
     connect(redoBtn, &QPushButton::clicked, this, &MainWindow::redoMove);
+    connect(stopBtn, &QPushButton::clicked, this, &MainWindow::stopEngine);
+    connect(moveNowBtn, &QPushButton::clicked, this, &MainWindow::moveNow);
 
     // ================================================================
     // CENTER PANEL (turn label + board with rank/file labels)
@@ -179,21 +199,68 @@ MainWindow::MainWindow(QWidget *parent)
     QShortcut *redoShortcut = new QShortcut(QKeySequence("Ctrl+Y"), this);
     connect(redoShortcut, &QShortcut::activated, this, &MainWindow::redoMove);
 
-    engineWatcher = new QFutureWatcher<Move>(this);
-    connect(engineWatcher, &QFutureWatcher<Move>::finished, this, &MainWindow::onEngineMoveReady);
+    QShortcut *stopShortcut = new QShortcut(QKeySequence("Esc"), this);
+    connect(stopShortcut, &QShortcut::activated, this, &MainWindow::stopEngine);
+
+    engineWatcher = new QFutureWatcher<PackedMove>(this);
+    connect(engineWatcher, &QFutureWatcher<PackedMove>::finished, this, &MainWindow::onEngineMoveReady);
+    ponderWatcher = new QFutureWatcher<PackedMove>(this);
+    connect(ponderWatcher, &QFutureWatcher<PackedMove>::finished, this, &MainWindow::onPonderFinished);
+
+    // Report which CPU kernel the engine picked on this machine
+    QString engineInfo = QString::fromStdString(Engine::info());
+    qInfo().noquote() << "Engine" << engineInfo;
+    statusBar()->showMessage("Engine " + engineInfo);
+
+    // Engine thinks for a fixed time per move; each finished iteration is
+    // reported in the status bar (the callback runs on the search thread)
+    engineLimits.movetime = 1000;
+    chessEngine.setThreads(QThread::idealThreadCount());
+    chessEngine.setInfoCallback([this](const SearchInfo &info) {
+        QString text = QString("Engine depth %1  score %2  nodes %3  %4 ms")
+                           .arg(info.depth).arg(info.score).arg(info.nodes).arg(info.timeMs);
+        QMetaObject::invokeMethod(this, [this, text]() { statusBar()->showMessage(text); },
+                                  Qt::QueuedConnection);
+    });
+
+    // External UCI engine: its output arrives as signals on the GUI thread
+    uciEngine = new UciEngine(this);
+    connect(uciEngine, &UciEngine::readyChanged, this, [this](bool ready) {
+        statusBar()->showMessage(ready ? "UCI engine " + uciEngine->name() + " ready" : "Built-in engine");
+    });
+    connect(uciEngine, &UciEngine::info, this,
+            [this](int depth, const QString &score, quint64 nodes, int timeMs, const QString &pv) {
+        statusBar()->showMessage(QString("%1 depth %2  score %3  nodes %4  %5 ms  %6")
+                                     .arg(uciEngine->name()).arg(depth).arg(score).arg(nodes).arg(timeMs).arg(pv));
+    });
+    connect(uciEngine, &UciEngine::bestMove, this, &MainWindow::onUciBestMove);
+    connect(uciEngine, &UciEngine::failed, this, &MainWindow::onUciFailed);
+
+    QAction *newGameAction = ui->menuChess_Game->addAction("New Game");
+    newGameAction->setShortcut(QKeySequence("Ctrl+N"));
+    connect(newGameAction, &QAction::triggered, this, &MainWindow::newGame);
+    QAction *loadEngineAction = ui->menuChess_Game->addAction("Load UCI Engine...");
+    connect(loadEngineAction, &QAction::triggered, this, &MainWindow::loadUciEngine);
+    QAction *builtInAction = ui->menuChess_Game->addAction("Use Built-in Engine");
+    connect(builtInAction, &QAction::triggered, this, &MainWindow::useBuiltInEngine);
 }
 
 
 MainWindow::~MainWindow()
 {
+    // stop the searches and the child process before the window they report to goes away
+    abortEngine();
+    disconnect(uciEngine, nullptr, this, nullptr);
+    uciEngine->shutdown();
     delete ui;
 }
 
 void MainWindow::updateBoardUI()
 {
+    const board::StateView state = gameBoard.currentState();
     for (int row = 0; row < 8; ++row) {
         for (int col = 0; col < 8; ++col) {
-            Piece piece = gameBoard.CurrentState[row][col];
+            Piece piece = state[row][col];
             QString iconPath;
 
             switch (piece) {
@@ -233,7 +300,7 @@ void MainWindow::handleTileClick()
     static int fromRow = -1, fromCol = -1;
 
     if (!pieceSelected) {
-        Piece piece = gameBoard.CurrentState[selectedRow][selectedCol];
+        Piece piece = gameBoard.currentState()[selectedRow][selectedCol];
         if (piece == EMPTY) return;
 
         bool isWhitePiece = (piece >= WQ && piece <= WB);
@@ -269,7 +336,7 @@ void MainWindow::handleTileClick()
 
         if (valid) {
             // Check for pawn promotion possibility
-            Piece movingPiece = gameBoard.CurrentState[fromRow][fromCol];
+            Piece movingPiece = gameBoard.currentState()[fromRow][fromCol];
             Piece promotionChoice = EMPTY;
             bool isPromotionMove = false;
 
@@ -287,12 +354,10 @@ void MainWindow::handleTileClick()
 
             QString notation = notationFromMove(mv);
 
-            std::string posKey = gameBoard.getPositionKey(isWhiteTurn);
-            gameBoard.positionCount[posKey]++;
-
-            if (gameBoard.positionCount[posKey] >= 3) {
+            if (gameBoard.repetitionCount() >= 3) {
                 turnLabel->setText("Draw by Threefold Repetition!");
                 updateBoardUI();
+                stopPondering();
                 return;
             }
 
@@ -312,6 +377,7 @@ void MainWindow::handleTileClick()
             if (gameBoard.halfMoveClock >= 100) {
                 turnLabel->setText("Draw by Fifty-Move Rule!");
                 updateBoardUI();
+                stopPondering();
                 return;
             }
 
@@ -331,27 +397,10 @@ void MainWindow::handleTileClick()
             if (inCheck) highlightKingInCheck(isWhiteTurn);
 
             // Only start engine if the side to move has legal moves (i.e., game not over)
-            if (!isWhiteTurn) {
-                auto nextMovesAfterHuman = gameBoard.getAllLegalMoves(isWhiteTurn);
-                if (!nextMovesAfterHuman.empty()) {
-                    // Start engine asynchronously (use a copy of the board for thread-safety)
-                    if (!engineWatcher->isRunning()) {
-                        engineThinking = true;
-                        // optional: update UI to indicate thinking (e.g., disable board or change label)
-                        turnLabel->setText("Engine thinking...");
-
-                        board boardCopy = gameBoard; // copy to run in background
-                        bool colorToMove = isWhiteTurn;
-                        int depth = engineDepth;
-
-                        QFuture<Move> future = QtConcurrent::run([this, boardCopy, colorToMove, depth]() mutable {
-                            // compute best move on copy -> returns Move relative to the same coordinates
-                            return chessEngine.findBestMove(boardCopy, colorToMove, depth);
-                        });
-                        engineWatcher->setFuture(future);
-                    }
-                }
-            }
+            if (!isWhiteTurn && !nextMoves.empty())
+                startEngineTurn();
+            else
+                stopPondering();
 
         }
 
@@ -376,7 +425,7 @@ void MainWindow::highlightKingInCheck(bool whiteTurn)
 
     for (int r = 0; r < 8; ++r)
         for (int c = 0; c < 8; ++c)
-            if (gameBoard.CurrentState[r][c] == king)
+            if (gameBoard.currentState()[r][c] == king)
                 boardButtons[r][c]->setStyleSheet("background-color: red; border: none;");
 }
 
@@ -408,6 +457,7 @@ Piece MainWindow::showPromotionDialog(bool whiteSide)
 void MainWindow::undoMove()
 {
     if (undoStack.empty()) return;
+    abortEngine();
 
     Move mv = undoStack.top();
     undoStack.pop();
@@ -588,7 +638,7 @@ void MainWindow::highlightMoves(const std::vector<std::pair<int,int>>& moves) {
         overlay->setAttribute(Qt::WA_TransparentForMouseEvents);
         overlay->setGeometry(0, 0, 80, 80);
 
-        bool isCapture = (gameBoard.CurrentState[r][c] != EMPTY);
+        bool isCapture = (gameBoard.currentState()[r][c] != EMPTY);
 
         if (!isCapture) {
 
@@ -656,13 +706,221 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event) {
 
 
 
+// Converts a move of the undo stack to the engine's encoding
+static PackedMove packedMove(const Move &mv)
+{
+    return PackedMove(squareOf(mv.fromR, mv.fromC), squareOf(mv.toR, mv.toC),
+                      mv.wasPromotion ? PackedMove::Promotion : PackedMove::Normal, mv.promotedTo);
+}
+
+void MainWindow::startEngineTurn()
+{
+    if (engineThinking || engineWatcher->isRunning()) return;
+
+    // Ponder hit: the search already running on this position becomes the turn
+    const bool ponderHit = ponderMove && !undoStack.empty()
+                           && board::moveToString(packedMove(undoStack.top())) == board::moveToString(ponderMove);
+    if (!ponderHit) stopPondering();
+
+    engineThinking = true;
+    // optional: update UI to indicate thinking (e.g., disable board or change label)
+    turnLabel->setText("Engine thinking...");
+
+    if (ponderHit) {
+        ponderMove = PackedMove();
+        ponderHitPlayed = true;
+        if (ponderWatcher->isFinished()) onPonderFinished();   // it ran out of depth before the hit
+        else searchPonderHit = true;
+        return;
+    }
+
+    // A loaded UCI engine searches in its own process; bestmove arrives in onUciBestMove
+    if (uciEngine->isReady()) {
+        uciEngine->go(gameMovesUci(), engineLimits.movetime);
+        return;
+    }
+
+    // Start engine asynchronously (use a copy of the board for thread-safety)
+    board boardCopy = gameBoard; // copy to run in background
+    bool colorToMove = isWhiteTurn;
+    SearchLimits limits = engineLimits;
+    searchStop = false;
+    limits.stop = &searchStop;
+
+    QFuture<PackedMove> future = QtConcurrent::run([this, boardCopy, colorToMove, limits]() mutable {
+        // compute best move on copy -> returns Move relative to the same coordinates
+        return chessEngine.search(boardCopy, colorToMove, limits);
+    });
+    engineWatcher->setFuture(future);
+}
+
+// The game so far in coordinate notation, oldest move first (the GUI always
+// starts from the initial position)
+QStringList MainWindow::gameMovesUci() const
+{
+    std::stack<Move> moves = undoStack;
+    QStringList list;
+    while (!moves.empty()) {
+        list.prepend(QString::fromStdString(board::moveToString(packedMove(moves.top()))));
+        moves.pop();
+    }
+    return list;
+}
+
+// Searches the position after the reply the engine expects, with no clock,
+// while the human thinks (built-in engine only)
+void MainWindow::startPondering()
+{
+    stopPondering();
+    const PackedMove reply = chessEngine.ponderMove();
+    if (!reply || uciEngine->isReady()) return;
+
+    const std::vector<PackedMove> legal = gameBoard.getAllLegalMoves(isWhiteTurn);
+    if (std::find(legal.begin(), legal.end(), reply) == legal.end()) return;
+
+    board boardCopy = gameBoard;
+    boardCopy.makeMove(reply);
+    bool colorToMove = !isWhiteTurn;
+    SearchLimits limits = engineLimits;
+    limits.ponder = true;
+    searchStop = searchPonderHit = false;
+    limits.stop = &searchStop;
+    limits.ponderHit = &searchPonderHit;
+
+    ponderMove = reply;
+    QFuture<PackedMove> future = QtConcurrent::run([this, boardCopy, colorToMove, limits]() mutable {
+        return chessEngine.search(boardCopy, colorToMove, limits);
+    });
+    ponderWatcher->setFuture(future);
+}
+
+// Ponder miss (or the game changed): the search is dropped, its hash entries stay
+void MainWindow::stopPondering()
+{
+    ponderMove = PackedMove();
+    ponderHitPlayed = false;
+    if (!ponderWatcher->isRunning()) return;
+    searchStop = true;
+    ponderWatcher->waitForFinished();
+}
+
+// The search polls its stop token every thousand or so nodes, so this returns
+// within milliseconds; the late result is ignored
+void MainWindow::abortEngine()
+{
+    stopPondering();
+    if (!engineThinking) return;
+    engineThinking = false;
+    uciEngine->abort();
+    searchStop = true;
+    engineWatcher->waitForFinished();
+}
+
+// The human takes over the engine's move
+void MainWindow::stopEngine()
+{
+    if (!engineThinking) return;
+    abortEngine();
+
+    QString turnText = isWhiteTurn ? "White's Turn" : "Black's Turn";
+    if (gameBoard.isKingInCheck(isWhiteTurn)) turnText += " (in Check!)";
+    turnLabel->setText(turnText);
+    statusBar()->showMessage("Engine stopped: play its move yourself");
+}
+
+// Ends the engine's search; it plays the best move found so far
+void MainWindow::moveNow()
+{
+    if (!engineThinking) return;
+    uciEngine->stop();
+    searchStop = true;
+}
+
+void MainWindow::newGame()
+{
+    abortEngine();
+
+    gameBoard.reset_board();
+    undoStack = std::stack<Move>();
+    redoStack = std::stack<Move>();
+    moveHistoryList->clear();
+    fullMoveNumber = 0;
+    isWhiteTurn = true;
+    pieceSelected = false;
+    chessEngine.clearHash();
+    uciEngine->newGame();
+
+    clearHighlights();
+    updateBoardUI();
+    resetColors();
+    turnLabel->setText("White's Turn");
+}
+
+void MainWindow::onPonderFinished()
+{
+    if (!ponderHitPlayed) return;   // stopped after a miss
+    ponderHitPlayed = false;
+    applyEngineMove(ponderWatcher->result());
+}
+
+void MainWindow::loadUciEngine()
+{
+    if (engineThinking) {
+        statusBar()->showMessage("Wait for the engine to move before switching engines");
+        return;
+    }
+    QString program = QFileDialog::getOpenFileName(this, "Load UCI Engine");
+    if (program.isEmpty()) return;
+    stopPondering();
+
+    statusBar()->showMessage("Starting " + program + "...");
+    uciEngine->start(program);
+}
+
+void MainWindow::useBuiltInEngine()
+{
+    if (engineThinking) {
+        statusBar()->showMessage("Wait for the engine to move before switching engines");
+        return;
+    }
+    uciEngine->shutdown();
+    statusBar()->showMessage("Built-in engine");
+}
+
+void MainWindow::onUciBestMove(const QString &move)
+{
+    if (!engineThinking) return;   // answer to a search nobody waits for any more
+
+    PackedMove best;
+    for (PackedMove m : gameBoard.getAllLegalMoves(isWhiteTurn))
+        if (QString::fromStdString(board::moveToString(m)) == move) best = m;
+    if (!best) statusBar()->showMessage(uciEngine->name() + " sent an illegal move: " + move);
+
+    applyEngineMove(best);
+}
+
+// The external engine is gone; the built-in one takes over, including the
+// move it was thinking about
+void MainWindow::onUciFailed(const QString &reason)
+{
+    QMessageBox::warning(this, "UCI Engine", reason + "\nThe built-in engine takes over.");
+    if (engineThinking) {
+        engineThinking = false;
+        startEngineTurn();
+    }
+}
+
 void MainWindow::onEngineMoveReady()
 {
+    if (!engineThinking) return;   // aborted search
     // Engine finished computing
-    Move best = engineWatcher->result();
+    applyEngineMove(engineWatcher->result());
+}
 
-    // Basic validation: ensure returned move is within board (0..7)
-    if (best.fromR < 0 || best.fromR > 7 || best.toR < 0 || best.toR > 7) {
+void MainWindow::applyEngineMove(PackedMove best)
+{
+    // No move means the engine had no legal move to play
+    if (!best) {
         engineThinking = false;
         // restore UI
         QString turnText = isWhiteTurn ? "White's Turn" : "Black's Turn";
@@ -670,13 +928,9 @@ void MainWindow::onEngineMoveReady()
         return;
     }
 
-    // Record position key for repetition (use current side to move before engine move)
-    std::string posKey = gameBoard.getPositionKey(isWhiteTurn);
-    gameBoard.positionCount[posKey]++;
-
     // Apply engine move to real board (preserve promotion if present in best)
-    Move mv = gameBoard.makeMove(best.fromR, best.fromC, best.toR, best.toC,
-                                 best.wasPromotion ? best.promotedTo : EMPTY);
+    Move mv = gameBoard.makeMove(rowOf(best.from()), colOf(best.from()), rowOf(best.to()), colOf(best.to()),
+                                 best.kind() == PackedMove::Promotion ? best.promotion(isWhiteTurn) : EMPTY);
 
     undoStack.push(mv);
     while (!redoStack.empty()) redoStack.pop();
@@ -695,7 +949,7 @@ void MainWindow::onEngineMoveReady()
     addMoveToHistory(notation, false);
 
     // update UI: half-move / 3fold / 50-move checks
-    if (gameBoard.positionCount[posKey] >= 3) {
+    if (gameBoard.repetitionCount() >= 3) {
         turnLabel->setText("Draw by Threefold Repetition!");
         updateBoardUI();
         engineThinking = false;
@@ -729,5 +983,6 @@ void MainWindow::onEngineMoveReady()
     if (inCheck) highlightKingInCheck(isWhiteTurn);
 
     engineThinking = false;
+    if (!nextMoves.empty()) startPondering();
 }
 
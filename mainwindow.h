@@ -7,8 +7,10 @@
 #include <stack>
 #include <QListWidget>
 #include <utility>
+#include <atomic>
 #include "board.h"
 #include "engine.h"
+#include "uciengine.h"
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrent>
 
@@ -37,6 +39,14 @@ private slots:
     void undoMove();
     void redoMove();
     void onEngineMoveReady();
+    void stopEngine();
+    void moveNow();
+    void newGame();
+    void onPonderFinished();
+    void loadUciEngine();
+    void useBuiltInEngine();
+    void onUciBestMove(const QString &move);
+    void onUciFailed(const QString &reason);
 
 private:
     QPushButton* boardButtons[8][8];  // 2D grid of buttons
@@ -66,9 +76,29 @@ private:
 
 
     Engine chessEngine;
-    QFutureWatcher<Move> *engineWatcher = nullptr; // watcher for async engine run
-    int engineDepth = 5;                      // engine search depth (tuneable)
+    QFutureWatcher<PackedMove> *engineWatcher = nullptr; // watcher for async engine run
+    SearchLimits engineLimits;                // engine think time per move (set in the constructor)
     bool engineThinking = false;              // true while engine is thinking
+    std::atomic<bool> searchStop{false};      // stop token of the built-in engine's search
+
+    // Pondering: after its move the built-in engine searches the reply it
+    // expects on the human's time. If the human plays it, that search goes on
+    // as the engine's turn; otherwise it is stopped and its hash entries reused.
+    QFutureWatcher<PackedMove> *ponderWatcher = nullptr;
+    PackedMove ponderMove;                    // reply being pondered on, none when idle
+    bool ponderHitPlayed = false;             // the ponder search answers the engine's turn
+    std::atomic<bool> searchPonderHit{false}; // ponder-hit token of the ponder search
+
+    // Optional external engine in a child process; while it is ready it plays
+    // instead of chessEngine
+    UciEngine *uciEngine = nullptr;
+
+    void startEngineTurn();                   // start thinking for the side to move
+    void startPondering();                    // search the expected reply, if any
+    void stopPondering();                     // abort the ponder search and wait for it
+    void abortEngine();                       // end the engine's turn without a move
+    void applyEngineMove(PackedMove best);    // play the engine's answer (none: game over)
+    QStringList gameMovesUci() const;         // moves from the start, for the UCI engine
 
     Ui::MainWindow *ui;
 };
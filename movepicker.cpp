@@ -0,0 +1,134 @@
+#include "movepicker.h"
+#include <utility>
+
+namespace {
+
+// piece values for MVV-LVA, indexed by Piece
+const int OrderValue[13] = { 0, 9, 5, 1, 3, 20, 3, 9, 5, 1, 3, 20, 3 };
+
+// Moves the highest-scored entry among [i, moves.size()) to position i
+void pickNext(MoveList &moves, int *scores, size_t i)
+{
+    size_t best = i;
+    for (size_t j = i + 1; j < moves.size(); ++j)
+        if (scores[j] > scores[best]) best = j;
+    if (best != i) {
+        std::swap(moves[i], moves[best]);
+        std::swap(scores[i], scores[best]);
+    }
+}
+
+} // namespace
+
+MovePicker::MovePicker(const board &b, bool white, MoveBuffers &buffers, PackedMove hashMove,
+                       const PackedMove killers[2], PackedMove counterMove, const int (*history)[64])
+    : pos(b), white(white), buf(buffers), history(history), capturesOnly(false),
+      hashMove(hashMove), counterMove(counterMove), stage_(HashMove)
+{
+    this->killers[0] = killers[0];
+    this->killers[1] = killers[1];
+}
+
+MovePicker::MovePicker(const board &b, bool white, MoveBuffers &buffers, bool inCheck, const int (*history)[64])
+    : pos(b), white(white), buf(buffers), history(history), capturesOnly(!inCheck),
+      stage_(GenerateCaptures)
+{
+}
+
+PackedMove MovePicker::refutation(Stage s) const
+{
+    return s == Killer1 ? killers[0] : s == Killer2 ? killers[1] : counterMove;
+}
+
+bool MovePicker::isRefutation(PackedMove m) const
+{
+    for (int i = 0; i < refutationCount; ++i)
+        if (refutations[i] == m) return true;
+    return false;
+}
+
+PackedMove MovePicker::next()
+{
+    while (true) {
+        switch (stage_) {
+        case HashMove:
+            stage_ = GenerateCaptures;
+            if (hashMove && pos.isPseudoLegal(hashMove, white) && pos.isLegal(hashMove, white))
+                return emit(HashMove, hashMove);
+            hashMove = PackedMove();
+            break;
+
+        case GenerateCaptures: {
+            pos.legalCaptures(buf.captures, white);
+            for (size_t i = 0; i < buf.captures.size(); ++i) {
+                const PackedMove m = buf.captures[i];
+                const Piece promo = m.kind() == PackedMove::Promotion ? m.promotion(white) : EMPTY;
+                buf.captureScores[i] = 64 * (OrderValue[pos.capturedPiece(m)] + OrderValue[promo])
+                                     - OrderValue[pos.movedPiece(m)];
+            }
+            cur = badCount = 0;
+            stage_ = GoodCaptures;
+            break;
+        }
+
+        case GoodCaptures:
+            while (cur < buf.captures.size()) {
+                pickNext(buf.captures, buf.captureScores, cur);
+                const PackedMove m = buf.captures[cur++];
+                if (m == hashMove) continue;
+
+                // taking something at least as valuable never loses; otherwise ask SEE
+                const Piece promo = m.kind() == PackedMove::Promotion ? m.promotion(white) : EMPTY;
+                const int victim = OrderValue[pos.capturedPiece(m)] + OrderValue[promo];
+                if (victim < OrderValue[pos.movedPiece(m)] && pos.see(m) < 0) {
+                    buf.captures[badCount++] = m;   // badCount < cur: never overwrites an unpicked move
+                    continue;
+                }
+                return emit(GoodCaptures, m);
+            }
+            stage_ = capturesOnly ? BadCaptures : Killer1;
+            cur = 0;
+            break;
+
+        case Killer1:
+        case Killer2:
+        case CounterMove: {
+            const Stage s = stage_;
+            stage_ = Stage(stage_ + 1);
+            const PackedMove m = refutation(s);
+            if (m && m != hashMove && !isRefutation(m) && pos.isPseudoLegal(m, white)
+                && !pos.isCapture(m) && m.kind() != PackedMove::Promotion && pos.isLegal(m, white)) {
+                refutations[refutationCount++] = m;
+                return emit(s, m);
+            }
+            break;
+        }
+
+        case GenerateQuiets:
+            pos.legalQuiets(buf.quiets, white);
+            for (size_t i = 0; i < buf.quiets.size(); ++i)
+                buf.quietScores[i] = history[buf.quiets[i].from()][buf.quiets[i].to()];
+            cur = 0;
+            stage_ = Quiets;
+            break;
+
+        case Quiets:
+            while (cur < buf.quiets.size()) {
+                pickNext(buf.quiets, buf.quietScores, cur);
+                const PackedMove m = buf.quiets[cur++];
+                if (m != hashMove && !isRefutation(m)) return emit(Quiets, m);
+            }
+            stage_ = BadCaptures;
+            cur = 0;
+            break;
+
+        case BadCaptures:
+            if (cur < badCount) return emit(BadCaptures, buf.captures[cur++]);
+            stage_ = Done;
+            break;
+
+        case Done:
+            return PackedMove();
+        }
+    }
+}
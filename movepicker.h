@@ -0,0 +1,73 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "board.h"
+
+// Scratch space of one MovePicker. The search keeps one per ply in its
+// preallocated stack, so picking moves never allocates.
+struct MoveBuffers {
+    MoveList captures;                         // captures and queen promotions; bad ones moved to the front
+    MoveList quiets;
+    int captureScores[MoveList::Capacity];
+    int quietScores[MoveList::Capacity];
+};
+
+// Hands out the moves of a node one at a time, best first. Each group is
+// generated only when the previous one is used up, so a node that fails high
+// on the hash move or a capture never builds its quiet moves:
+//   1. hash move            - validated against the position, nothing generated
+//   2. good captures        - captures and queen promotions by MVV-LVA; those
+//                             losing material (SEE < 0) are set aside
+//   3. killers, counter-move - validated, quiet only
+//   4. quiet moves          - by history
+//   5. bad captures         - the ones set aside in 2, still by MVV-LVA
+// Within a group the next move is found by selection, not a full sort.
+// Generated moves are legal; moves from the tables are checked right before
+// they are returned.
+class MovePicker {
+public:
+    enum Stage {
+        HashMove, GenerateCaptures, GoodCaptures, Killer1, Killer2, CounterMove,
+        GenerateQuiets, Quiets, BadCaptures, Done
+    };
+
+    // main search; `history` is the butterfly table [from][to] of the side to move
+    MovePicker(const board &b, bool white, MoveBuffers &buffers, PackedMove hashMove,
+               const PackedMove killers[2], PackedMove counterMove, const int (*history)[64]);
+
+    // quiescence: good captures, then bad ones; every evasion when in check
+    MovePicker(const board &b, bool white, MoveBuffers &buffers, bool inCheck, const int (*history)[64]);
+
+    // the next move, or no move once all are used up
+    PackedMove next();
+
+    // group of the move last returned by next()
+    Stage stage() const { return current; }
+
+    // whether the quiet moves had to be generated
+    bool generatedQuiets() const { return stage_ > GenerateQuiets && !capturesOnly; }
+
+private:
+    PackedMove emit(Stage s, PackedMove m) { current = s; return m; }
+    PackedMove refutation(Stage s) const;
+    bool isRefutation(PackedMove m) const;
+
+    const board &pos;
+    const bool white;
+    MoveBuffers &buf;
+    const int (*history)[64];
+    const bool capturesOnly;
+
+    PackedMove hashMove;
+    PackedMove killers[2];
+    PackedMove counterMove;
+    PackedMove refutations[3];   // killers / counter-move actually returned
+    int refutationCount = 0;
+
+    Stage stage_;
+    Stage current = HashMove;
+    size_t cur = 0;              // next entry of the list being picked from
+    size_t badCount = 0;         // bad captures kept at the front of buf.captures
+};
+
+#endif // MOVEPICKER_H
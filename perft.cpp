@@ -0,0 +1,269 @@
+// Standalone move-generation checker and benchmark (no Qt).
+//
+//   perft [--fen "<FEN>"] [--depth N] [--divide] [--hash MB] [--threads N]
+//   perft --suite [--hash MB] [--threads N]
+//
+// Counts leaf nodes of the legal move tree. The last ply is bulk-counted (the
+// size of the legal move list), so the numbers measure generation speed rather
+// than make/unmake. --suite runs the reference positions below and fails if any
+// count differs or if one of the invalid FENs is accepted.
+
+#include "board.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------
+// Reference positions (chessprogramming.org perft results and the
+// en-passant / castling / promotion edge cases from the classic perft suite)
+// ----------------------------------------------
+struct SuiteEntry {
+    const char *name;
+    const char *fen;
+    int depth;
+    unsigned long long nodes;
+};
+
+static const SuiteEntry Suite[] = {
+    { "start position",           StartFEN, 5, 4865609ULL },
+    { "kiwipete",                 "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603ULL },
+    { "position 3",               "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ULL },
+    { "position 4",               "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333ULL },
+    { "position 4 mirrored",      "r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 4, 422333ULL },
+    { "position 5",               "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487ULL },
+    { "illegal ep move #1",       "3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888ULL },
+    { "illegal ep move #2",       "8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133ULL },
+    { "ep capture checks",        "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467ULL },
+    { "short castle gives check", "5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072ULL },
+    { "long castle gives check",  "3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711ULL },
+    { "castle rights",            "r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206ULL },
+    { "castling prevented",       "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476ULL },
+    { "promote out of check",     "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001ULL },
+    { "discovered check",         "8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658ULL },
+    { "promote to give check",    "4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342ULL },
+    { "underpromote to check",    "8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683ULL },
+    { "self stalemate",           "K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217ULL },
+    { "stalemate and checkmate",  "8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584ULL },
+    { "stalemate and checkmate 2","8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527ULL },
+};
+
+// Boards move generation cannot handle; loadFEN must reject each of them
+struct RejectedEntry {
+    const char *name;
+    const char *fen;
+};
+
+static const RejectedEntry Rejected[] = {
+    { "pawn on rank 8",           "P3k3/8/8/8/8/8/8/4K3 w - - 0 1" },
+    { "pawn on rank 1",           "4k3/8/8/8/8/8/8/p3K3 b - - 0 1" },
+    { "no white king",            "4k3/8/8/8/8/8/8/8 w - - 0 1" },
+    { "two black kings",          "k3k3/8/8/8/8/8/8/4K3 w - - 0 1" },
+    { "side not to move in check","4k3/8/8/8/8/8/8/K3R3 w - - 0 1" },
+};
+
+// ----------------------------------------------
+// Optional perft hash table. Entries are written lock-free; the key is stored
+// XOR-ed with the data so a torn write from another thread never validates.
+// ----------------------------------------------
+class PerftTable {
+public:
+    explicit PerftTable(size_t mb) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= mb * 1024 * 1024) count *= 2;
+        entries.reset(new Entry[count]);
+        mask = count - 1;
+    }
+
+    bool probe(std::uint64_t key, int depth, unsigned long long &nodes) const {
+        const Entry &e = entries[key & mask];
+        std::uint64_t data = e.data.load(std::memory_order_relaxed);
+        std::uint64_t check = e.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || int(data & 0xFF) != depth) return false;
+        nodes = data >> 8;
+        return true;
+    }
+
+    void store(std::uint64_t key, int depth, unsigned long long nodes) {
+        Entry &e = entries[key & mask];
+        std::uint64_t data = (nodes << 8) | std::uint64_t(depth);
+        e.data.store(data, std::memory_order_relaxed);
+        e.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+    std::unique_ptr<Entry[]> entries;
+    size_t mask = 0;
+};
+
+// ----------------------------------------------
+// PERFT
+// ----------------------------------------------
+static unsigned long long perft(board &b, bool white, int depth, PerftTable *table)
+{
+    MoveList moves;
+    b.legalMoves(moves, white);
+    if (depth <= 1) return depth == 1 ? moves.size() : 1; // bulk count at the last ply
+
+    std::uint64_t key = 0;
+    unsigned long long nodes = 0;
+    if (table) {
+        key = b.hashKey();
+        if (table->probe(key, depth, nodes)) return nodes;
+    }
+
+    for (PackedMove m : moves) {
+        b.makeMove(m);
+        nodes += perft(b, !white, depth - 1, table);
+        b.unmakeMove(m);
+    }
+
+    if (table) table->store(key, depth, nodes);
+    return nodes;
+}
+
+struct RootResult {
+    PackedMove move;
+    unsigned long long nodes;
+};
+
+// Splits the root moves over `threads` workers, each with its own board copy.
+static std::vector<RootResult> divide(const board &root, bool white, int depth, int threads, PerftTable *table)
+{
+    board b = root;
+    std::vector<PackedMove> moves = b.getAllLegalMoves(white);
+    std::vector<RootResult> results(moves.size());
+    std::atomic<size_t> next{0};
+
+    auto worker = [&]() {
+        board local = root;
+        for (size_t i = next++; i < moves.size(); i = next++) {
+            const PackedMove m = moves[i];
+            local.makeMove(m);
+            results[i] = { m, depth > 1 ? perft(local, !white, depth - 1, table) : 1ULL };
+            local.unmakeMove(m);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool) th.join();
+
+    return results;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static unsigned long long runPosition(const board &b, bool white, int depth, int threads,
+                                      PerftTable *table, bool printDivide, double &seconds)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<RootResult> results = divide(b, white, depth, threads, table);
+    seconds = secondsSince(start);
+
+    unsigned long long total = 0;
+    for (const RootResult &r : results) {
+        total += r.nodes;
+        if (printDivide)
+            std::printf("%s: %llu\n", board::moveToString(r.move).c_str(), r.nodes);
+    }
+    return total;
+}
+
+static void usage()
+{
+    std::printf("usage: perft [--fen \"<FEN>\"] [--depth N] [--divide] [--hash MB] [--threads N]\n"
+                "       perft --suite [--hash MB] [--threads N]\n");
+}
+
+int main(int argc, char *argv[])
+{
+    std::string fen = StartFEN;
+    int depth = 5;
+    int threads = 1;
+    size_t hashMb = 0;
+    bool printDivide = false;
+    bool suite = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--fen" && hasValue) fen = argv[++i];
+        else if (arg == "--depth" && hasValue) depth = std::atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--hash" && hasValue) hashMb = size_t(std::atoi(argv[++i]));
+        else if (arg == "--divide") printDivide = true;
+        else if (arg == "--suite") suite = true;
+        else { usage(); return 2; }
+    }
+    if (depth < 1) {   // the root itself is not a move to divide on
+        std::printf("depth must be at least 1\n");
+        return 2;
+    }
+
+    board b;
+    std::printf("attack kernel: %s, threads: %d, hash: %zu MB\n", cpuKernelName(ActiveKernel), threads, hashMb);
+
+    std::unique_ptr<PerftTable> table;
+    if (hashMb) table.reset(new PerftTable(hashMb));
+
+    if (suite) {
+        int failures = 0;
+        unsigned long long totalNodes = 0;
+        double totalSeconds = 0;
+
+        for (const SuiteEntry &e : Suite) {
+            bool white = true;
+            if (!b.loadFEN(e.fen, white)) {
+                std::printf("%-26s bad FEN\n", e.name);
+                ++failures;
+                continue;
+            }
+            double seconds = 0;
+            unsigned long long nodes = runPosition(b, white, e.depth, threads, table.get(), false, seconds);
+            bool ok = nodes == e.nodes;
+            failures += !ok;
+            totalNodes += nodes;
+            totalSeconds += seconds;
+            std::printf("%-26s depth %d  %12llu  %s  %.3f s\n", e.name, e.depth, nodes,
+                        ok ? "ok  " : "FAIL", seconds);
+            if (!ok) std::printf("    expected %llu\n", e.nodes);
+        }
+        for (const RejectedEntry &e : Rejected) {
+            bool white = true;
+            const bool ok = !b.loadFEN(e.fen, white);
+            failures += !ok;
+            std::printf("%-26s rejected        %s\n", e.name, ok ? "ok  " : "FAIL");
+        }
+
+        std::printf("%d failure(s), %llu nodes in %.3f s (%.0f nodes/s)\n", failures, totalNodes,
+                    totalSeconds, totalSeconds > 0 ? totalNodes / totalSeconds : 0.0);
+        return failures ? 1 : 0;
+    }
+
+    bool white = true;
+    if (!b.loadFEN(fen, white)) {
+        std::printf("invalid FEN: %s\n", fen.c_str());
+        return 2;
+    }
+
+    double seconds = 0;
+    unsigned long long nodes = runPosition(b, white, depth, threads, table.get(), printDivide, seconds);
+    std::printf("\ndepth %d: %llu nodes in %.3f s (%.0f nodes/s)\n", depth, nodes, seconds,
+                seconds > 0 ? nodes / seconds : 0.0);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "psqt.h"
+
+int PsqtMg[13][64];
+int PsqtEg[13][64];
+
+const int PhaseWeight[13] = { 0, 4, 2, 0, 1, 0, 1, 4, 2, 0, 1, 0, 1 };
+
+namespace {
+
+// ----------------------------------------------
+// Tables are written from white's side as the board is drawn: the first row is
+// rank 8 (row 0 of the board), the last row rank 1. Black uses them mirrored.
+// ----------------------------------------------
+const int PawnMg[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    { 50, 50, 50, 50, 50, 50, 50, 50},
+    { 10, 10, 20, 30, 30, 20, 10, 10},
+    {  5,  5, 10, 25, 25, 10,  5,  5},
+    {  0,  0,  0, 20, 20,  0,  0,  0},
+    {  5, -5,-10,  0,  0,-10, -5,  5},
+    {  5, 10, 10,-20,-20, 10, 10,  5},
+    {  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+// in the endgame only advancement counts
+const int PawnEg[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    { 80, 80, 80, 80, 80, 80, 80, 80},
+    { 50, 50, 50, 50, 50, 50, 50, 50},
+    { 30, 30, 30, 30, 30, 30, 30, 30},
+    { 15, 15, 15, 15, 15, 15, 15, 15},
+    {  5,  5,  5,  5,  5,  5,  5,  5},
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  0,  0,  0,  0,  0,  0,  0,  0}
+};
+
+const int Knight[8][8] = {
+    {-50,-40,-30,-30,-30,-30,-40,-50},
+    {-40,-20,  0,  5,  5,  0,-20,-40},
+    {-30,  5, 10, 15, 15, 10,  5,-30},
+    {-30,  0, 15, 20, 20, 15,  0,-30},
+    {-30,  5, 15, 20, 20, 15,  5,-30},
+    {-30,  0, 10, 15, 15, 10,  0,-30},
+    {-40,-20,  0,  0,  0,  0,-20,-40},
+    {-50,-40,-30,-30,-30,-30,-40,-50}
+};
+
+const int Bishop[8][8] = {
+    {-20,-10,-10,-10,-10,-10,-10,-20},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-10,  0,  5, 10, 10,  5,  0,-10},
+    {-10,  5,  5, 10, 10,  5,  5,-10},
+    {-10,  0, 10, 10, 10, 10,  0,-10},
+    {-10, 10, 10, 10, 10, 10, 10,-10},
+    {-10,  5,  0,  0,  0,  0,  5,-10},
+    {-20,-10,-10,-10,-10,-10,-10,-20}
+};
+
+const int Rook[8][8] = {
+    {  0,  0,  0,  0,  0,  0,  0,  0},
+    {  5, 10, 10, 10, 10, 10, 10,  5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    { -5,  0,  0,  0,  0,  0,  0, -5},
+    {  0,  0,  0,  5,  5,  0,  0,  0}
+};
+
+const int Queen[8][8] = {
+    {-20,-10,-10, -5, -5,-10,-10,-20},
+    {-10,  0,  0,  0,  0,  0,  0,-10},
+    {-10,  0,  5,  5,  5,  5,  0,-10},
+    { -5,  0,  5,  5,  5,  5,  0, -5},
+    {  0,  0,  5,  5,  5,  5,  0, -5},
+    {-10,  5,  5,  5,  5,  5,  0,-10},
+    {-10,  0,  5,  0,  0,  0,  0,-10},
+    {-20,-10,-10, -5, -5,-10,-10,-20}
+};
+
+// midgame: stay behind the pawn shield; endgame: head for the centre
+const int KingMg[8][8] = {
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-30,-40,-40,-50,-50,-40,-40,-30},
+    {-20,-30,-30,-40,-40,-30,-30,-20},
+    {-10,-20,-20,-20,-20,-20,-20,-10},
+    { 20, 20,  0,  0,  0,  0, 20, 20},
+    { 20, 30, 10,  0,  0, 10, 30, 20}
+};
+
+const int KingEg[8][8] = {
+    {-50,-40,-30,-20,-20,-30,-40,-50},
+    {-30,-20,-10,  0,  0,-10,-20,-30},
+    {-30,-10, 20, 30, 30, 20,-10,-30},
+    {-30,-10, 30, 40, 40, 30,-10,-30},
+    {-30,-10, 30, 40, 40, 30,-10,-30},
+    {-30,-10, 20, 30, 30, 20,-10,-30},
+    {-30,-30,  0,  0,  0,  0,-30,-30},
+    {-50,-30,-30,-30,-30,-30,-30,-50}
+};
+
+// material, same in both phases
+int materialValue(Piece p)
+{
+    switch (p) {
+    case WP: case BP: return 100;
+    case WN: case BN: return 300;
+    case WB: case BB: return 320;
+    case WR: case BR: return 500;
+    case WQ: case BQ: return 900;
+    default: return 0;
+    }
+}
+
+void fillPiece(Piece white, Piece black, const int mg[8][8], const int eg[8][8])
+{
+    for (int sq = 0; sq < 64; ++sq) {
+        int r = rowOf(sq), c = colOf(sq);
+        PsqtMg[white][sq] = materialValue(white) + mg[r][c];
+        PsqtEg[white][sq] = materialValue(white) + eg[r][c];
+        PsqtMg[black][sq] = -(materialValue(black) + mg[7 - r][c]);
+        PsqtEg[black][sq] = -(materialValue(black) + eg[7 - r][c]);
+    }
+}
+
+bool buildTables()
+{
+    fillPiece(WP, BP, PawnMg, PawnEg);
+    fillPiece(WN, BN, Knight, Knight);
+    fillPiece(WB, BB, Bishop, Bishop);
+    fillPiece(WR, BR, Rook, Rook);
+    fillPiece(WQ, BQ, Queen, Queen);
+    fillPiece(WK, BK, KingMg, KingEg);
+    return true;
+}
+
+} // namespace
+
+void initPsqt()
+{
+    // function-local static: built exactly once, thread-safe since C++11
+    static const bool built = buildTables();
+    (void)built;
+}
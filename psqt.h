@@ -0,0 +1,29 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "board.h"
+
+// --- material + piece-square tables ------------------------------------------
+// One entry per (piece, square) holding material plus the square bonus, already
+// signed: positive for white pieces, negative for black. The board adds and
+// subtracts these as pieces are placed and removed, so the running totals are
+// the white-relative material+PST score in both game phases.
+extern int PsqtMg[13][64];
+extern int PsqtEg[13][64];
+
+// Game phase: knights and bishops count 1, rooks 2, queens 4. The starting
+// position (and anything heavier) is MaxPhase; bare kings and pawns are 0.
+extern const int PhaseWeight[13];
+const int MaxPhase = 24;
+
+// Builds the tables. Safe to call more than once; only the first call does work.
+void initPsqt();
+
+// Blends the midgame and endgame scores by phase
+inline int taperedScore(int mg, int eg, int phase)
+{
+    if (phase > MaxPhase) phase = MaxPhase;
+    return (mg * phase + eg * (MaxPhase - phase)) / MaxPhase;
+}
+
+#endif // PSQT_H
@@ -0,0 +1,172 @@
+#include "tt.h"
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// ----------------------------------------------
+// Entry layout (data word):
+//   bits  0-15  move
+//   bits 16-31  score (int16)
+//   bits 32-39  depth (int8)
+//   bits 40-41  bound
+//   bits 42-47  age of the search that wrote it
+// ----------------------------------------------
+namespace {
+
+std::uint64_t packData(std::uint16_t move, int score, int depth, TTBound bound, std::uint8_t age)
+{
+    return std::uint64_t(move)
+         | std::uint64_t(std::uint16_t(std::int16_t(score))) << 16
+         | std::uint64_t(std::uint8_t(std::int8_t(depth))) << 32
+         | std::uint64_t(bound) << 40
+         | std::uint64_t(age) << 42;
+}
+
+int dataDepth(std::uint64_t d) { return std::int8_t(std::uint8_t(d >> 32)); }
+TTBound dataBound(std::uint64_t d) { return TTBound((d >> 40) & 3); }
+std::uint8_t dataAge(std::uint64_t d) { return std::uint8_t((d >> 42) & 0x3F); }
+
+void *allocateBlock(std::size_t bytes, std::size_t alignment)
+{
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    return std::aligned_alloc(alignment, bytes);
+#endif
+}
+
+void freeBlock(void *p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+TranspositionTable::~TranspositionTable()
+{
+    release();
+}
+
+void TranspositionTable::release()
+{
+    if (!buckets) return;
+    std::destroy_n(buckets, mask + 1);
+    freeBlock(buckets);
+    buckets = nullptr;
+    mask = 0;
+}
+
+void TranspositionTable::resize(std::size_t megabytes, bool hugePages)
+{
+    release();
+    if (megabytes == 0) return;
+
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) count *= 2;
+
+    const std::size_t bytes = count * sizeof(Bucket);
+    const std::size_t alignment = (hugePages && bytes >= (2u << 20)) ? (2u << 20) : alignof(Bucket);
+    void *block = allocateBlock(bytes, alignment);
+    if (!block) throw std::bad_alloc();
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (hugePages) madvise(block, bytes, MADV_HUGEPAGE);
+#endif
+
+    // The atomics must be constructed before use; clear() gives them their values
+    buckets = static_cast<Bucket *>(block);
+    std::uninitialized_default_construct_n(buckets, count);
+    mask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear()
+{
+    for (std::size_t i = 0; i <= mask && buckets; ++i)
+        for (Entry &e : buckets[i].entries) {
+            e.check.store(0, std::memory_order_relaxed);
+            e.data.store(0, std::memory_order_relaxed);
+        }
+    age = 0;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTHit &hit) const
+{
+    if (!buckets) return false;
+
+    const Bucket &b = buckets[key & mask];
+    for (const Entry &e : b.entries) {
+        std::uint64_t data = e.data.load(std::memory_order_relaxed);
+        std::uint64_t check = e.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key || dataBound(data) == BoundNone) continue;
+
+        hit.move = PackedMove::fromRaw(std::uint16_t(data));
+        hit.score = std::int16_t(std::uint16_t(data >> 16));
+        hit.depth = dataDepth(data);
+        hit.bound = dataBound(data);
+        return true;
+    }
+    return false;
+}
+
+// Replacement: an entry for the same key is overwritten unless it holds a much
+// deeper result for a non-exact bound. Otherwise the victim is the entry with
+// the lowest depth, where every search of age difference counts as 8 plies.
+void TranspositionTable::store(std::uint64_t key, PackedMove move, int score, int depth, TTBound bound)
+{
+    if (!buckets) return;
+
+    Bucket &b = buckets[key & mask];
+    Entry *victim = nullptr;
+    int victimWorth = 0;
+
+    for (Entry &e : b.entries) {
+        std::uint64_t data = e.data.load(std::memory_order_relaxed);
+        std::uint64_t check = e.check.load(std::memory_order_relaxed);
+
+        if ((check ^ data) == key) {
+            if (bound != BoundExact && depth + 4 < dataDepth(data) && dataAge(data) == age)
+                return;
+            if (!move) move = PackedMove::fromRaw(std::uint16_t(data));   // keep the old best move
+            victim = &e;
+            break;
+        }
+
+        int relativeAge = (age - dataAge(data)) & 0x3F;
+        int worth = dataBound(data) == BoundNone ? -1000 : dataDepth(data) - 8 * relativeAge;
+        if (!victim || worth < victimWorth) {
+            victim = &e;
+            victimWorth = worth;
+        }
+    }
+
+    std::uint64_t data = packData(move.raw(), score, depth, bound, age);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const
+{
+    if (!buckets) return 0;
+
+    int used = 0;
+    const std::size_t sample = mask + 1 < 250 ? mask + 1 : 250;
+    for (std::size_t i = 0; i < sample; ++i)
+        for (const Entry &e : buckets[i].entries) {
+            std::uint64_t data = e.data.load(std::memory_order_relaxed);
+            if (dataBound(data) != BoundNone && dataAge(data) == age) ++used;
+        }
+    return int(used * 1000 / (sample * 4));
+}
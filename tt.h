@@ -0,0 +1,80 @@
+#ifndef TT_H
+#define TT_H
+
+#include "board.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bound type of a stored score
+enum TTBound : std::uint8_t {
+    BoundNone  = 0,
+    BoundUpper = 1,   // failed low: score <= stored value
+    BoundLower = 2,   // failed high: score >= stored value
+    BoundExact = 3
+};
+
+// Decoded view of one table entry
+struct TTHit {
+    PackedMove move;      // best move found, none if zero
+    int score;            // as stored, i.e. mate scores relative to this node
+    int depth;
+    TTBound bound;
+};
+
+// Fixed-size transposition table shared by all search threads.
+//
+// Entries are grouped four to a 64-byte bucket so a probe touches one cache
+// line. Each entry is two atomic words: the packed data and key ^ data. Readers
+// and writers never lock; a torn write (data from one store, key from another)
+// fails the XOR check and reads as a miss.
+class TranspositionTable {
+public:
+    TranspositionTable() = default;
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    // Reallocates to the largest power-of-two bucket count fitting in `mb`
+    // megabytes and clears it. With `hugePages` the block is 2 MB aligned and
+    // the kernel is asked to back it with huge pages (Linux only; elsewhere
+    // the flag just changes the alignment).
+    void resize(std::size_t mb, bool hugePages = false);
+    void clear();
+
+    // Call once per search so entries from older searches are replaced first
+    void newSearch() { age = (age + 1) & 0x3F; }
+
+    bool probe(std::uint64_t key, TTHit &hit) const;
+    void store(std::uint64_t key, PackedMove move, int score, int depth, TTBound bound);
+
+    // Pulls the bucket for `key` into cache ahead of the probe
+    void prefetch(std::uint64_t key) const {
+        if (!buckets) return;
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&buckets[key & mask]);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        _mm_prefetch(reinterpret_cast<const char *>(&buckets[key & mask]), _MM_HINT_T0);
+#endif
+    }
+
+    // Filled entries of the current search in a sample, per mille
+    int hashfull() const;
+
+private:
+    void release();
+
+    struct Entry {
+        std::atomic<std::uint64_t> check;   // key ^ data
+        std::atomic<std::uint64_t> data;
+    };
+    struct alignas(64) Bucket {
+        Entry entries[4];
+    };
+
+    Bucket *buckets = nullptr;
+    std::size_t mask = 0;
+    std::uint8_t age = 0;
+};
+
+#endif // TT_H
@@ -0,0 +1,269 @@
+// UCI front end for the engine (no Qt): commands on stdin, answers on stdout.
+//
+//   uci, isready, ucinewgame, quit
+//   setoption name Hash value <MB> | setoption name Threads value <N>
+//     | setoption name Ponder value true|false
+//     | setoption name LargePages value true|false
+//   position startpos | fen <FEN> [moves <move> ...]
+//   go [depth N] [movetime ms] [nodes N] [wtime ms] [btime ms] [winc ms]
+//      [binc ms] [movestogo N] [infinite] [ponder]
+//   stop, ponderhit
+//
+// The search runs on its own thread, so `stop` and `isready` are answered
+// while it thinks. An `info` line follows every completed iteration; after
+// `go infinite` the best move is held back until `stop`, after `go ponder`
+// until `stop` or `ponderhit`, as the protocol asks. `bestmove` names the
+// expected reply as its ponder move. `uciok` is followed by an `info string`
+// naming the attack kernel Engine::info() reports for this machine.
+
+#include "board.h"
+#include "engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+// stdout is written from the reader and the search thread
+static std::mutex outputMutex;
+
+static void send(const std::string &line)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+static std::string lower(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    return text;
+}
+
+// "cp 34", or "mate 3" / "mate -2" in moves once the score is a mate
+static std::string formatScore(int score)
+{
+    const int plies = Engine::MateScore - std::abs(score);
+    if (plies > Engine::MaxDepth) return "cp " + std::to_string(score);
+    const int moves = (plies + 1) / 2;
+    return "mate " + std::to_string(score > 0 ? moves : -moves);
+}
+
+static std::string formatInfo(const SearchInfo &info)
+{
+    const std::uint64_t nps = info.nodes * 1000 / std::uint64_t(std::max(1, info.timeMs));
+    std::string line = "info depth " + std::to_string(info.depth) + " score " + formatScore(info.score)
+                     + " nodes " + std::to_string(info.nodes) + " nps " + std::to_string(nps)
+                     + " hashfull " + std::to_string(info.hashfull) + " time " + std::to_string(info.timeMs);
+    if (!info.pv.empty()) line += " pv " + info.pv;
+    return line;
+}
+
+class UciSession {
+public:
+    UciSession();
+    void run();
+
+private:
+    void position(std::istringstream &in);
+    void go(std::istringstream &in);
+    void setOption(std::istringstream &in);
+    void stopSearch();
+    void ponderHit();
+
+    Engine engine;
+    board pos;
+    bool white = true;
+
+    std::future<void> searching;      // valid while a search thread exists
+    std::atomic<bool> stopToken{false};   // polled by the running search
+    std::atomic<bool> ponderHitToken{false};
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    bool stopReceived = false;        // `stop` arrived for the current search
+    bool ponderHitReceived = false;   // `ponderhit` arrived for the current search
+
+    std::size_t hashMb = Engine::DefaultHashMb;
+    bool largePages = false;          // back the hash with huge pages where the OS allows
+};
+
+UciSession::UciSession()
+{
+    bool w = true;
+    pos.loadFEN(StartFEN, w);
+    white = w;
+    engine.setInfoCallback([](const SearchInfo &info) { send(formatInfo(info)); });
+}
+
+void UciSession::run()
+{
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string command;
+        in >> command;
+
+        if (command == "uci") {
+            send("id name ChessGame");
+            send("id author ChessGame developers");
+            send("option name Hash type spin default " + std::to_string(Engine::DefaultHashMb) + " min 1 max 65536");
+            send("option name Threads type spin default 1 min 1 max 256");
+            send("option name Ponder type check default false");
+            send("option name LargePages type check default false");
+            send("uciok");
+            send("info string " + Engine::info());   // which attack kernel this machine runs
+        } else if (command == "isready") {
+            send("readyok");
+        } else if (command == "ucinewgame") {
+            stopSearch();
+            engine.clearHash();
+        } else if (command == "setoption") {
+            setOption(in);
+        } else if (command == "position") {
+            position(in);
+        } else if (command == "go") {
+            go(in);
+        } else if (command == "stop") {
+            stopSearch();
+        } else if (command == "ponderhit") {
+            ponderHit();
+        } else if (command == "quit") {
+            break;
+        } else if (!command.empty()) {
+            send("info string unknown command: " + command);
+        }
+    }
+    stopSearch();
+}
+
+// Options change only between searches
+void UciSession::setOption(std::istringstream &in)
+{
+    std::string token, name, value;
+    in >> token;                                   // "name"
+    while (in >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    in >> value;
+
+    stopSearch();
+    const int number = std::atoi(value.c_str());
+    if (lower(name) == "hash" && number > 0) {
+        hashMb = std::size_t(number);
+        engine.setHashSize(hashMb, largePages);
+    } else if (lower(name) == "largepages") {
+        largePages = lower(value) == "true";
+        engine.setHashSize(hashMb, largePages);
+    } else if (lower(name) == "threads" && number > 0) engine.setThreads(number);
+    else if (lower(name) == "ponder") {}   // the GUI decides when to send `go ponder`
+    else send("info string unsupported option: " + name);
+}
+
+// The position is replaced only if the FEN and every move are valid
+void UciSession::position(std::istringstream &in)
+{
+    std::string token, fen;
+    in >> token;
+    if (token == "startpos") {
+        fen = StartFEN;
+        in >> token;
+    } else if (token == "fen") {
+        while (in >> token && token != "moves") fen += token + " ";
+    } else {
+        send("info string expected startpos or fen");
+        return;
+    }
+
+    board next;
+    bool nextWhite = true;
+    if (!next.loadFEN(fen, nextWhite)) {
+        send("info string invalid fen: " + fen);
+        return;
+    }
+    if (token == "moves") {
+        while (in >> token) {
+            PackedMove m;
+            if (!next.parseMove(token, nextWhite, m)) {
+                send("info string illegal move: " + token);
+                return;
+            }
+            next.makeMove(m);
+            nextWhite = !nextWhite;
+        }
+    }
+
+    stopSearch();
+    pos = next;
+    white = nextWhite;
+}
+
+void UciSession::go(std::istringstream &in)
+{
+    SearchLimits limits;
+    std::string token;
+    while (in >> token) {
+        if (token == "depth") in >> limits.depth;
+        else if (token == "movetime") in >> limits.movetime;
+        else if (token == "nodes") in >> limits.nodes;
+        else if (token == "wtime") in >> limits.wtime;
+        else if (token == "btime") in >> limits.btime;
+        else if (token == "winc") in >> limits.winc;
+        else if (token == "binc") in >> limits.binc;
+        else if (token == "movestogo") in >> limits.movestogo;
+        else if (token == "infinite") limits.infinite = true;
+        else if (token == "ponder") limits.ponder = true;
+    }
+
+    stopSearch();
+    stopReceived = ponderHitReceived = false;
+    stopToken = ponderHitToken = false;
+    limits.stop = &stopToken;
+    limits.ponderHit = &ponderHitToken;
+    searching = std::async(std::launch::async, [this, limits, b = pos, w = white]() mutable {
+        PackedMove best = engine.search(b, w, limits);
+        PackedMove reply = engine.ponderMove();
+        if (limits.infinite || limits.ponder) {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            stopSignal.wait(lock, [this, &limits]() { return stopReceived || (limits.ponder && ponderHitReceived); });
+        }
+        std::string line = "bestmove " + (best ? board::moveToString(best) : std::string("0000"));
+        if (best && reply) line += " ponder " + board::moveToString(reply);
+        send(line);
+    });
+}
+
+// Stops the running search, if any, and waits for its `bestmove`
+void UciSession::stopSearch()
+{
+    if (!searching.valid()) return;
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopReceived = true;
+    }
+    stopSignal.notify_all();
+    stopToken = true;
+    searching.get();
+}
+
+// The expected move was played: the ponder search becomes a timed one
+void UciSession::ponderHit()
+{
+    if (!searching.valid()) return;
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        ponderHitReceived = true;
+    }
+    stopSignal.notify_all();
+    ponderHitToken = true;
+}
+
+int main()
+{
+    std::ios::sync_with_stdio(false);
+    UciSession session;
+    session.run();
+    return 0;
+}
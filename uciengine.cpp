@@ -0,0 +1,173 @@
+#include "uciengine.h"
+#include <QFileInfo>
+#include <QTimer>
+
+// How long past its movetime an engine may take to answer before it counts as hung
+static const int ResponseGraceMs = 5000;
+
+UciEngine::UciEngine(QObject *parent)
+    : QObject(parent)
+    , responseTimer(new QTimer(this))
+{
+    responseTimer->setSingleShot(true);
+    connect(responseTimer, &QTimer::timeout, this, &UciEngine::onNoResponse);
+}
+
+UciEngine::~UciEngine()
+{
+    shutdown();
+}
+
+void UciEngine::start(const QString &program)
+{
+    shutdown();
+
+    engineName = QFileInfo(program).fileName();
+    process = new QProcess(this);
+    connect(process, &QProcess::readyReadStandardOutput, this, &UciEngine::readOutput);
+    connect(process, &QProcess::errorOccurred, this, &UciEngine::onProcessError);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &UciEngine::onFinished);
+
+    process->start(program, QStringList());
+    send("uci");   // buffered by QProcess until the child is running
+}
+
+// Asks the engine to quit, and kills it if it does not within a second
+void UciEngine::shutdown()
+{
+    if (!process) return;
+
+    disconnect(process, nullptr, this, nullptr);
+    if (process->state() != QProcess::NotRunning) {
+        send("quit");
+        if (!process->waitForFinished(1000)) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+    process->deleteLater();   // may be called from one of its own signals
+    process = nullptr;
+    responseTimer->stop();
+
+    const bool wasReady = ready;
+    ready = thinking = false;
+    abandoned = 0;
+    if (wasReady) emit readyChanged(false);
+}
+
+void UciEngine::go(const QStringList &moves, int movetimeMs)
+{
+    if (!ready) return;
+
+    QString position = "position startpos";
+    if (!moves.isEmpty()) position += " moves " + moves.join(' ');
+    send(position);
+    send(QString("go movetime %1").arg(movetimeMs));
+    thinking = true;
+    responseTimer->start(movetimeMs + ResponseGraceMs);
+}
+
+void UciEngine::newGame()
+{
+    if (!ready) return;   // a fresh engine has nothing to forget
+    send("ucinewgame");
+    send("isready");
+}
+
+void UciEngine::stop()
+{
+    if (thinking) send("stop");
+}
+
+void UciEngine::abort()
+{
+    if (!thinking) return;
+    send("stop");
+    thinking = false;
+    ++abandoned;
+    responseTimer->stop();
+}
+
+void UciEngine::send(const QString &command)
+{
+    if (process) process->write((command + "\n").toUtf8());
+}
+
+void UciEngine::readOutput()
+{
+    while (process && process->canReadLine())
+        parseLine(QString::fromUtf8(process->readLine()).trimmed());
+}
+
+void UciEngine::parseLine(const QString &line)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    const QStringList tokens = line.split(' ', Qt::SkipEmptyParts);
+#else
+    const QStringList tokens = line.split(' ', QString::SkipEmptyParts);
+#endif
+    if (tokens.isEmpty()) return;
+    const QString &command = tokens[0];
+
+    if (command == "id" && tokens.size() > 2 && tokens[1] == "name") {
+        engineName = tokens.mid(2).join(' ');
+    } else if (command == "uciok") {
+        send("isready");
+    } else if (command == "readyok") {
+        if (!ready) {
+            ready = true;
+            emit readyChanged(true);
+        }
+    } else if (command == "bestmove" && tokens.size() > 1) {
+        if (abandoned > 0) {   // answers arrive in order: this one is for an aborted search
+            --abandoned;
+            return;
+        }
+        thinking = false;
+        responseTimer->stop();
+        emit bestMove(tokens[1]);
+    } else if (command == "info") {
+        // only the per-iteration lines (those with a score) are of interest
+        int depth = 0, timeMs = 0;
+        quint64 nodes = 0;
+        QString score, pv;
+        for (int i = 1; i < tokens.size(); ++i) {
+            const QString &key = tokens[i];
+            const bool hasValue = i + 1 < tokens.size();
+            if (key == "depth" && hasValue) depth = tokens[++i].toInt();
+            else if (key == "nodes" && hasValue) nodes = tokens[++i].toULongLong();
+            else if (key == "time" && hasValue) timeMs = tokens[++i].toInt();
+            else if (key == "score" && i + 2 < tokens.size()) {
+                score = tokens[i + 1] == "mate" ? "#" + tokens[i + 2] : tokens[i + 2];
+                i += 2;
+            } else if (key == "pv") {
+                pv = tokens.mid(i + 1).join(' ');
+                break;
+            }
+        }
+        if (depth > 0 && !score.isEmpty()) emit info(depth, score, nodes, timeMs, pv);
+    }
+}
+
+void UciEngine::onProcessError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart && error != QProcess::WriteError) return;   // crashes arrive as finished()
+    const QString reason = process ? process->errorString() : QString("engine error");
+    shutdown();
+    emit failed(reason);
+}
+
+void UciEngine::onFinished(int exitCode, QProcess::ExitStatus status)
+{
+    const QString reason = status == QProcess::CrashExit ? QString("engine crashed")
+                                                         : QString("engine exited (code %1)").arg(exitCode);
+    shutdown();
+    emit failed(reason);
+}
+
+// The engine is alive but did not answer its `go` in time
+void UciEngine::onNoResponse()
+{
+    shutdown();
+    emit failed("engine not responding");
+}
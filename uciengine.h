@@ -0,0 +1,69 @@
+#ifndef UCIENGINE_H
+#define UCIENGINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+
+// A UCI engine running as a child process (chess-uci or any other UCI
+// binary). Commands are written to its stdin; its output is read as it
+// arrives and turned into signals, so the GUI thread never waits on it. A
+// crash ends only the child process; an engine that does not answer a `go`
+// well after its movetime is shut down and reported through failed().
+class UciEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UciEngine(QObject *parent = nullptr);
+    ~UciEngine();
+
+    // Launches `program` and starts the UCI handshake; ready() follows once
+    // the engine has answered. Any engine already running is shut down first.
+    void start(const QString &program);
+    void shutdown();
+
+    bool isReady() const { return ready; }
+    QString name() const { return engineName; }
+
+    // Tells the engine a new game starts, so it drops what it learnt in the last one
+    void newGame();
+
+    // Sends the game so far (moves in coordinate notation from the start
+    // position) and asks for a move within `movetimeMs`
+    void go(const QStringList &moves, int movetimeMs);
+
+    // ends the current search; the engine still answers with bestMove()
+    void stop();
+
+    // ends the current search and drops its answer
+    void abort();
+
+signals:
+    void readyChanged(bool ready);
+    void info(int depth, const QString &score, quint64 nodes, int timeMs, const QString &pv);
+    void bestMove(const QString &move);
+    void failed(const QString &reason);
+
+private slots:
+    void readOutput();
+    void onProcessError(QProcess::ProcessError error);
+    void onFinished(int exitCode, QProcess::ExitStatus status);
+    void onNoResponse();
+
+private:
+    void send(const QString &command);
+    void parseLine(const QString &line);
+
+    QProcess *process = nullptr;
+    QTimer *responseTimer;    // runs while a `go` waits for its bestmove
+    QString engineName;
+    bool ready = false;       // handshake done
+    bool thinking = false;    // a `go` is waiting for its bestmove
+    int abandoned = 0;        // bestmoves still due from aborted searches
+};
+
+#endif // UCIENGINE_H